@@ -0,0 +1,169 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the shared memory layout of the live button state export
+**
+**  Notes:
+**    1. This header is the interface for local non-cFE processes. It only
+**       depends on <stdint.h> and GCC/Clang __atomic builtins so it can be
+**       included by C and C++ readers built outside of cFS.
+**    2. The segment is a POSIX shared memory object named by the
+**       SHM_EXPORT_NAME ini configuration, "/rpi_btn" by default. Readers
+**       open it read-only and mmap() sizeof(RPI_BTN_Shm_t) bytes:
+**
+**         Fd  = shm_open("/rpi_btn", O_RDONLY, 0);
+**         Shm = mmap(NULL, sizeof(RPI_BTN_Shm_t), PROT_READ, MAP_SHARED, Fd, 0);
+**
+**    3. The header fields are constant once Magic is set. Readers must check
+**       Magic, Version and Size before using anything else. Version is
+**       incremented whenever the layout changes, fields are only appended
+**       within a version so Size may grow.
+**    4. Seq is a sequence lock. The RPI_BTN child task is the only writer,
+**       it makes Seq odd while it updates State and the edge ring and even
+**       when it's done. Readers copy what they need between
+**       RPI_BTN_ShmReadBegin() and RPI_BTN_ShmReadRetry() and retry if the
+**       copy may be torn. Reads make no system calls:
+**
+**         do
+**         {
+**            Seq   = RPI_BTN_ShmReadBegin(Shm);
+**            State = Shm->State;
+**         } while (RPI_BTN_ShmReadRetry(Shm, Seq));
+**
+**    5. Every edge has a sequence number starting at 1. Edges the app knows
+**       it lost consume sequence numbers too. Edge n is stored at
+**       Edge[(n-1) % RPI_BTN_SHM_EDGE_RING_LEN] and the newest is
+**       State.EdgeSeq. An entry whose Number isn't n was lost before it
+**       reached the export, the status telemetry loss counters say where.
+**       A reader that remembers the last EdgeSeq it saw knows how many
+**       edges it missed.
+**    6. Times are CLOCK_MONOTONIC nanoseconds so readers can compare them
+**       with their own clock_gettime(CLOCK_MONOTONIC) readings.
+**
+*/
+
+#ifndef _rpi_btn_shm_
+#define _rpi_btn_shm_
+
+/*
+** Includes
+*/
+
+#include <stdint.h>
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define RPI_BTN_SHM_MAGIC    0x4E544252u  /* "RBTN" in little-endian byte order */
+#define RPI_BTN_SHM_VERSION  2
+
+#define RPI_BTN_SHM_EDGE_RING_LEN  64     /* Power of 2 */
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+typedef struct
+{
+
+   uint64_t  TimeNs;          /* Time the child task detected the edge */
+   uint32_t  Number;          /* Edge sequence number, the first edge is 1 */
+   uint8_t   Level;           /* Line level read after the edge */
+   uint8_t   Spare[3];
+
+} RPI_BTN_ShmEdge_t;
+
+
+typedef struct
+{
+
+   uint64_t  LastEdgeNs;      /* Time of the newest edge, 0 if there hasn't been one */
+   uint32_t  PressedCount;    /* Preserved across app restarts when the CDS is available */
+   uint32_t  EdgeSeq;         /* Sequence number of the newest edge */
+   uint8_t   Connected;       /* 1 if the button GPIO pin is connected */
+   uint8_t   GpioPin;
+   uint8_t   Level;           /* Line level read after the newest edge */
+   uint8_t   Spare[5];
+
+} RPI_BTN_ShmState_t;
+
+
+typedef struct
+{
+
+   /*
+   ** Header, constant once Magic is set
+   */
+
+   uint32_t  Magic;           /* RPI_BTN_SHM_MAGIC, 0 while the writer initializes the segment */
+   uint16_t  Version;         /* RPI_BTN_SHM_VERSION */
+   uint16_t  EdgeRingLen;     /* RPI_BTN_SHM_EDGE_RING_LEN */
+   uint32_t  Size;            /* sizeof(RPI_BTN_Shm_t) */
+   uint32_t  WriterPid;       /* cFE process ID, use kill(WriterPid, 0) to check it's alive */
+
+   /*
+   ** Sequence locked data
+   */
+
+   uint32_t  Seq;             /* Odd while the writer is updating the data below */
+   uint32_t  Spare;
+
+   RPI_BTN_ShmState_t  State;
+   RPI_BTN_ShmEdge_t   Edge[RPI_BTN_SHM_EDGE_RING_LEN];
+
+} RPI_BTN_Shm_t;
+
+
+/******************************************************************************
+** Function: RPI_BTN_ShmReadBegin
+**
+** Start a sequence locked read and return the sequence to pass to
+** RPI_BTN_ShmReadRetry().
+**
+*/
+static inline uint32_t RPI_BTN_ShmReadBegin(const RPI_BTN_Shm_t *Shm)
+{
+
+   return __atomic_load_n(&Shm->Seq, __ATOMIC_ACQUIRE);
+
+} /* End RPI_BTN_ShmReadBegin() */
+
+
+/******************************************************************************
+** Function: RPI_BTN_ShmReadRetry
+**
+** Return nonzero if the data copied since RPI_BTN_ShmReadBegin() may be torn
+** and the read must be repeated.
+**
+** Notes:
+**   1. An odd sequence means a write was in progress when the read started.
+**      If the writer stops while Seq is odd every read retries so readers
+**      that can't block should bound their retries.
+**
+*/
+static inline int RPI_BTN_ShmReadRetry(const RPI_BTN_Shm_t *Shm, uint32_t Seq)
+{
+
+   __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+   return (Seq & 1) || (__atomic_load_n(&Shm->Seq, __ATOMIC_RELAXED) != Seq);
+
+} /* End RPI_BTN_ShmReadRetry() */
+
+
+#endif /* _rpi_btn_shm_ */
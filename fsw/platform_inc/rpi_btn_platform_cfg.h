@@ -39,4 +39,47 @@
 
 #define RPI_BTN_DEV_STR_MAX  64  // Must accommodate the longest "BTN_DEV_STR_*" string defined in the ini file
 
+#define RPI_BTN_CDS_NAME           "BUTTON"  // Critical Data Store block name, must be unique within the app
+#define RPI_BTN_CDS_EDGE_HIST_LEN  8         // Number of recent edges preserved across resets
+
+#define RPI_BTN_SELF_TEST_MAX_SAMPLES  1000  // Maximum toggles in a loopback self-test
+#define RPI_BTN_SELF_TEST_MAX_RATE_HZ  500   // Child task waits have millisecond resolution
+
+#define RPI_BTN_KEYPAD_MAX_ROWS  8  // Rows * columns must not exceed 64, one bit per key
+#define RPI_BTN_KEYPAD_MAX_COLS  8
+
+#define RPI_BTN_CDEV_KERNEL_EVENTS  1024  // GPIO character device kernel event queue length, the kernel limit is 1024
+#define RPI_BTN_CDEV_READ_BATCH     64    // Edge events read per read() call
+
+#define RPI_BTN_MAX_ROUTES  8  // Button event routes in BTN_ROUTES, each has its own message
+
+#define RPI_BTN_MAX_MACROS          8     // Event macros in the MACRO_TBL_FILE table
+#define RPI_BTN_MACRO_MAX_PAYLOAD   64    // Event macro command payload bytes, excluding the command header
+#define RPI_BTN_MACRO_TBL_MAX_CHAR  4096  // Event macro table file size limit
+
+#define RPI_BTN_CAPTURE_EDGES  256  // Edge capture buffer length, must be a power of 2
+
+
+/******************************************************************************
+** Button Profile
+**
+** Set RPI_BTN_FIXED_PROFILE to 1 for deployments where the button pin, event
+** engine and edge mode never change. The RPI_BTN_FIXED_* values replace the
+** BTN_GPIO_PIN, BTN_EVENT_ENGINE and BTN_EDGE ini file configurations and the
+** child task edge path is compiled for a single line without any engine or
+** edge mode dispatch. When RPI_BTN_FIXED_PROFILE is 0 the ini file is used.
+*/
+
+#define RPI_BTN_ENGINE_POLL      1
+#define RPI_BTN_ENGINE_IO_URING  2  // Requires the RPI_BTN_IO_URING_ENGINE build option
+
+#define RPI_BTN_EDGE_BOTH     0
+#define RPI_BTN_EDGE_RISING   1
+#define RPI_BTN_EDGE_FALLING  2
+
+#define RPI_BTN_FIXED_PROFILE   0
+#define RPI_BTN_FIXED_GPIO_PIN  4
+#define RPI_BTN_FIXED_ENGINE    RPI_BTN_ENGINE_POLL
+#define RPI_BTN_FIXED_EDGE      RPI_BTN_EDGE_BOTH
+
 #endif /* _rpi_btn_platform_cfg_ */
@@ -73,41 +73,131 @@
 
 #define CFG_CMD_PIPE_NAME    APP_CMD_PIPE_NAME
 #define CFG_CMD_PIPE_DEPTH   APP_CMD_PIPE_DEPTH
+#define CFG_CMD_DIAG_ENABLE  CMD_DIAG_ENABLE
 
 #define CFG_RPI_BTN_CMD_TOPICID         RPI_BTN_CMD_TOPICID
 #define CFG_BC_SCH_1_HZ_TOPICID         BC_SCH_1_HZ_TOPICID
 #define CFG_RPI_BTN_STATUS_TLM_TOPICID  RPI_BTN_STATUS_TLM_TOPICID
+#define CFG_RPI_BTN_STATE_TLM_TOPICID   RPI_BTN_STATE_TLM_TOPICID
+#define CFG_RPI_BTN_SELF_TEST_TLM_TOPICID  RPI_BTN_SELF_TEST_TLM_TOPICID
+#define CFG_RPI_BTN_CHILD_DIAG_TLM_TOPICID RPI_BTN_CHILD_DIAG_TLM_TOPICID
+#define CFG_RPI_BTN_KEY_EVENT_TLM_TOPICID  RPI_BTN_KEY_EVENT_TLM_TOPICID
+#define CFG_RPI_BTN_ENCODER_TLM_TOPICID    RPI_BTN_ENCODER_TLM_TOPICID
+#define CFG_RPI_BTN_PULSE_TLM_TOPICID      RPI_BTN_PULSE_TLM_TOPICID
+#define CFG_RPI_BTN_PWM_TLM_TOPICID        RPI_BTN_PWM_TLM_TOPICID
+#define CFG_RPI_BTN_BUTTON_EVENT_TLM_TOPICID RPI_BTN_BUTTON_EVENT_TLM_TOPICID
+#define CFG_RPI_BTN_CAPTURE_TLM_TOPICID    RPI_BTN_CAPTURE_TLM_TOPICID
+#define CFG_RPI_BTN_CMD_DIAG_TLM_TOPICID   RPI_BTN_CMD_DIAG_TLM_TOPICID
+
+#define CFG_STATUS_TLM_TICK_TOPICID   STATUS_TLM_TICK_TOPICID
+#define CFG_STATUS_TLM_DIVIDER        STATUS_TLM_DIVIDER
+#define CFG_STATUS_TLM_CHANGE_ONLY    STATUS_TLM_CHANGE_ONLY
+#define CFG_STATUS_TLM_KEEPALIVE_TICKS STATUS_TLM_KEEPALIVE_TICKS
 
 #define CFG_CHILD_NAME       CHILD_NAME 
 #define CFG_CHILD_PERF_ID    CHILD_PERF_ID
 #define CFG_CHILD_STACK_SIZE CHILD_STACK_SIZE
 #define CFG_CHILD_PRIORITY   CHILD_PRIORITY
+#define CFG_CHILD_DIAG_ENABLE CHILD_DIAG_ENABLE
 
-#define CFG_BTN_PIN               BTN_GPIO_PIN
+#define CFG_BTN_MODE              BTN_MODE
+#define CFG_BTN_GPIO_PIN          BTN_GPIO_PIN
+#define CFG_BTN_EVENT_ENGINE      BTN_EVENT_ENGINE
+#define CFG_BTN_EDGE              BTN_EDGE
 #define CFG_BTN_DEV_STR_DIRECTION BTN_DEV_STR_DIRECTION
 #define CFG_BTN_DEV_STR_EDGE      BTN_DEV_STR_EDGE
 #define CFG_BTN_DEV_STR_EXPORT    BTN_DEV_STR_EXPORT
 #define CFG_BTN_DEV_STR_UNEXPORT  BTN_DEV_STR_UNEXPORT
 #define CFG_BTN_DEV_STR_VALUE     BTN_DEV_STR_VALUE
 
+#define CFG_SELF_TEST_LOOPBACK    SELF_TEST_LOOPBACK
+#define CFG_SELF_TEST_OUT_PIN     SELF_TEST_OUT_PIN
+#define CFG_SELF_TEST_DEV_STR_SIM SELF_TEST_DEV_STR_SIM
+
+#define CFG_KEYPAD_ROW_PINS       KEYPAD_ROW_PINS
+#define CFG_KEYPAD_COL_PINS       KEYPAD_COL_PINS
+#define CFG_KEYPAD_ACTIVE_LEVEL   KEYPAD_ACTIVE_LEVEL
+#define CFG_KEYPAD_SCAN_MS        KEYPAD_SCAN_MS
+
+#define CFG_GPIO_CDEV_CHIP        GPIO_CDEV_CHIP
+
+#define CFG_ENCODER_PIN_A         ENCODER_PIN_A
+#define CFG_ENCODER_PIN_B         ENCODER_PIN_B
+#define CFG_ENCODER_TLM_MS        ENCODER_TLM_MS
+
+#define CFG_PULSE_PIN             PULSE_PIN
+#define CFG_PULSE_TLM_MS          PULSE_TLM_MS
+
+#define CFG_PWM_PIN               PWM_PIN
+#define CFG_PWM_WINDOW_MS         PWM_WINDOW_MS
+
+#define CFG_SHM_EXPORT_NAME       SHM_EXPORT_NAME
+
+#define CFG_BTN_ACTIVE_LEVEL      BTN_ACTIVE_LEVEL
+#define CFG_BTN_ROUTES            BTN_ROUTES
+#define CFG_GESTURE_LONG_MS       GESTURE_LONG_MS
+#define CFG_GESTURE_DOUBLE_MS     GESTURE_DOUBLE_MS
+
+#define CFG_MACRO_TBL_FILE        MACRO_TBL_FILE
+
 #define APP_CONFIG(XX) \
    XX(APP_CFE_NAME,char*) \
    XX(APP_PERF_ID,uint32) \
    XX(APP_CMD_PIPE_NAME,char*) \
    XX(APP_CMD_PIPE_DEPTH,uint32) \
+   XX(CMD_DIAG_ENABLE,uint32) \
    XX(RPI_BTN_CMD_TOPICID,uint32) \
    XX(BC_SCH_1_HZ_TOPICID,uint32) \
    XX(RPI_BTN_STATUS_TLM_TOPICID,uint32) \
+   XX(RPI_BTN_STATE_TLM_TOPICID,uint32) \
+   XX(RPI_BTN_SELF_TEST_TLM_TOPICID,uint32) \
+   XX(RPI_BTN_CHILD_DIAG_TLM_TOPICID,uint32) \
+   XX(RPI_BTN_KEY_EVENT_TLM_TOPICID,uint32) \
+   XX(RPI_BTN_ENCODER_TLM_TOPICID,uint32) \
+   XX(RPI_BTN_PULSE_TLM_TOPICID,uint32) \
+   XX(RPI_BTN_PWM_TLM_TOPICID,uint32) \
+   XX(RPI_BTN_BUTTON_EVENT_TLM_TOPICID,uint32) \
+   XX(RPI_BTN_CAPTURE_TLM_TOPICID,uint32) \
+   XX(RPI_BTN_CMD_DIAG_TLM_TOPICID,uint32) \
+   XX(STATUS_TLM_TICK_TOPICID,uint32) \
+   XX(STATUS_TLM_DIVIDER,uint32) \
+   XX(STATUS_TLM_CHANGE_ONLY,uint32) \
+   XX(STATUS_TLM_KEEPALIVE_TICKS,uint32) \
    XX(CHILD_NAME,char*) \
    XX(CHILD_PERF_ID,uint32) \
    XX(CHILD_STACK_SIZE,uint32) \
    XX(CHILD_PRIORITY,uint32) \
+   XX(CHILD_DIAG_ENABLE,uint32) \
+   XX(BTN_MODE,char*) \
    XX(BTN_GPIO_PIN,uint32) \
+   XX(BTN_EVENT_ENGINE,char*) \
+   XX(BTN_EDGE,char*) \
    XX(BTN_DEV_STR_DIRECTION,char*) \
    XX(BTN_DEV_STR_EDGE,char*) \
    XX(BTN_DEV_STR_EXPORT,char*) \
    XX(BTN_DEV_STR_UNEXPORT,char*) \
-   XX(BTN_DEV_STR_VALUE,char*)
+   XX(BTN_DEV_STR_VALUE,char*) \
+   XX(SELF_TEST_LOOPBACK,char*) \
+   XX(SELF_TEST_OUT_PIN,uint32) \
+   XX(SELF_TEST_DEV_STR_SIM,char*) \
+   XX(KEYPAD_ROW_PINS,char*) \
+   XX(KEYPAD_COL_PINS,char*) \
+   XX(KEYPAD_ACTIVE_LEVEL,uint32) \
+   XX(KEYPAD_SCAN_MS,uint32) \
+   XX(GPIO_CDEV_CHIP,char*) \
+   XX(ENCODER_PIN_A,uint32) \
+   XX(ENCODER_PIN_B,uint32) \
+   XX(ENCODER_TLM_MS,uint32) \
+   XX(PULSE_PIN,uint32) \
+   XX(PULSE_TLM_MS,uint32) \
+   XX(PWM_PIN,uint32) \
+   XX(PWM_WINDOW_MS,uint32) \
+   XX(SHM_EXPORT_NAME,char*) \
+   XX(BTN_ACTIVE_LEVEL,uint32) \
+   XX(BTN_ROUTES,char*) \
+   XX(GESTURE_LONG_MS,uint32) \
+   XX(GESTURE_DOUBLE_MS,uint32) \
+   XX(MACRO_TBL_FILE,char*)
 
 DECLARE_ENUM(Config,APP_CONFIG)
 
@@ -122,6 +212,16 @@ DECLARE_ENUM(Config,APP_CONFIG)
 
 #define RPI_BTN_BASE_EID  (APP_C_FW_APP_BASE_EID +  0)
 #define BUTTON_BASE_EID   (APP_C_FW_APP_BASE_EID + 20)
+#define EVT_ENGINE_BASE_EID (APP_C_FW_APP_BASE_EID + 40)
+#define KEYPAD_BASE_EID     (APP_C_FW_APP_BASE_EID + 50)
+#define GPIO_CDEV_BASE_EID  (APP_C_FW_APP_BASE_EID + 60)
+#define ENCODER_BASE_EID    (APP_C_FW_APP_BASE_EID + 70)
+#define PULSE_BASE_EID      (APP_C_FW_APP_BASE_EID + 80)
+#define PWM_BASE_EID        (APP_C_FW_APP_BASE_EID + 90)
+#define SHM_EXPORT_BASE_EID (APP_C_FW_APP_BASE_EID + 100)
+#define EVENT_ROUTE_BASE_EID (APP_C_FW_APP_BASE_EID + 110)
+#define CAPTURE_BASE_EID     (APP_C_FW_APP_BASE_EID + 120)
+#define EVENT_MACRO_BASE_EID (APP_C_FW_APP_BASE_EID + 130)
 
 
 #endif /* _app_cfg_ */
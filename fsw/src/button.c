@@ -30,11 +30,17 @@
 ** Include Files:
 */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE    /* RUSAGE_THREAD */
+#endif
+
 #include <string.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdlib.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/resource.h>
 
 
 #include "button.h"
@@ -47,19 +53,38 @@
 #define DIR_IN_STR  "in"
 #define DIR_OUT_STR "out"
 
+#define EDGE_BATCH  EVT_ENGINE_MAX_LINES
 
-/**********************/
-/** Type Definitions **/
-/**********************/
+#define SELF_TEST_WIRED_STR      "wired"
+#define SELF_TEST_SIMULATED_STR  "simulated"
 
-typedef enum
-{
+/*
+** Button profile, see rpi_btn_platform_cfg.h. A fixed profile replaces ini
+** file configurations with compile-time constants. EDGE_MODE() is a constant
+** so the edge mode checks are resolved by the compiler and with a single
+** edge type the level reported for an edge is implied by the edge. The
+** event engine is selected by evt_engine.c.
+*/
+#if RPI_BTN_FIXED_PROFILE
+   #define PROFILE_GPIO_PIN()      RPI_BTN_FIXED_GPIO_PIN
+   #define PROFILE_EDGE()          RPI_BTN_FIXED_EDGE
+   #define EDGE_MODE()             RPI_BTN_FIXED_EDGE
+#else
+   #define PROFILE_GPIO_PIN()      INITBL_GetIntConfig(Button->IniTbl, CFG_BTN_GPIO_PIN)
+   #define PROFILE_EDGE()          EdgeStrToEdge(INITBL_GetStrConfig(Button->IniTbl, CFG_BTN_EDGE))
+   #define EDGE_MODE()             (Button->Edge)
+#endif
 
-   DIR_IN  = 1,
-   DIR_OUT = 2
+#if RPI_BTN_FIXED_PROFILE && (RPI_BTN_FIXED_EDGE != RPI_BTN_EDGE_BOTH)
+   #define EDGE_LEVEL(EdgePtr)  (RPI_BTN_FIXED_EDGE == RPI_BTN_EDGE_RISING)
+#else
+   #define EDGE_LEVEL(EdgePtr)  ((EdgePtr)->Level)
+#endif
 
-} Direction_t;
 
+/**********************/
+/** Type Definitions **/
+/**********************/
 
 /**********************/
 /** Global File Data **/
@@ -67,16 +92,40 @@ typedef enum
 
 static BUTTON_Class_t*  Button = NULL;
 
+/* Indexed by RPI_BTN_EDGE_* */
+static const char* EdgeStr[] = { "both", "rising", "falling" };
+
 
 /*******************************/
 /** Local Function Prototypes **/
 /*******************************/
 
 static void ButtonPressed(void);
-static bool OpenGpio(int GpioPin, Direction_t Direction);
+static void ButtonProcessEdges(const EVT_ENGINE_Edge_t *Edges, int EdgeCnt);
+static void ButtonService(bool WakeRequested);
+static int  ButtonTimeoutMs(void);
+static void InitCds(void);
+static bool ModeConnected(void);
+static void ModeProcessEdges(const EVT_ENGINE_Edge_t *Edges, int EdgeCnt);
+static void ModeService(bool WakeRequested);
+static BUTTON_Mode_t ModeStrToMode(const char *Mode);
+static int  ModeTimeoutMs(void);
+static void PublishState(void);
+static void ResetChildStatus(void);
+static void SampleChildDiag(void);
+static void SequenceEdge(int Level);
+static void OpenQueryFile(int GpioPin);
 static bool ReadGpio(void);
 static bool SetGpioEdge(int GpioPin, const char *Edge);
-//static bool WriteGpio(int Bit);
+#if !RPI_BTN_FIXED_PROFILE
+static uint8 EdgeStrToEdge(const char *Edge);
+#endif
+static bool OpenSelfTestOutput(void);
+static void SelfTestComplete(void);
+static void SelfTestEdge(uint64 DetectNs);
+static void SelfTestExecute(void);
+static int  SelfTestTimeoutMs(void);
+static bool WriteGpio(int FileDescr, int Bit);
 
 
 /******************************************************************************
@@ -95,23 +144,75 @@ void BUTTON_Constructor(BUTTON_Class_t *ButtonPtr, INITBL_Class_t *IniTbl)
    
    memset(Button, 0, sizeof(BUTTON_Class_t));
    Button->IniTbl  = IniTbl;
-   Button->GpioPin = INITBL_GetIntConfig(Button->IniTbl, CFG_BTN_GPIO_PIN);
+   Button->GpioPin = PROFILE_GPIO_PIN();
+   Button->Edge    = PROFILE_EDGE();
+   Button->ActiveLevel = (INITBL_GetIntConfig(Button->IniTbl, CFG_BTN_ACTIVE_LEVEL) != 0);
+   Button->Mode    = ModeStrToMode(INITBL_GetStrConfig(Button->IniTbl, CFG_BTN_MODE));
+
+   InitCds();
 
-   if (OpenGpio(Button->GpioPin, DIR_IN))
+   if (EVT_ENGINE_Constructor(&Button->EvtEngine, INITBL_GetStrConfig(Button->IniTbl, CFG_BTN_EVENT_ENGINE)))
    {
       
-      Button->PollFileDescr[0].fd      = Button->FileDescr;
-      Button->PollFileDescr[0].events  = POLLPRI;
-      Button->PollFileDescr[0].revents = 0;
-      
-      if (SetGpioEdge(Button->GpioPin, "both"))
+      if (Button->Mode == BUTTON_MODE_KEYPAD)
+      {
+         KEYPAD_Constructor(&Button->Keypad, IniTbl);
+      }
+      else if (Button->Mode == BUTTON_MODE_ENCODER)
+      {
+         if (ENCODER_Constructor(&Button->Encoder, IniTbl) &&
+             EVT_ENGINE_AddEventFile(&Button->EvtEngine, Button->Encoder.GpioCdev.FileDescr) < 0)
+         {
+            Button->Encoder.Connected = false;
+         }
+      }
+      else if (Button->Mode == BUTTON_MODE_PULSE)
+      {
+         if (PULSE_Constructor(&Button->Pulse, IniTbl) &&
+             EVT_ENGINE_AddEventFile(&Button->EvtEngine, Button->Pulse.GpioCdev.FileDescr) < 0)
+         {
+            Button->Pulse.Connected = false;
+         }
+      }
+      else if (Button->Mode == BUTTON_MODE_PWM)
+      {
+         if (PWM_Constructor(&Button->Pwm, IniTbl) &&
+             EVT_ENGINE_AddEventFile(&Button->EvtEngine, Button->Pwm.GpioCdev.FileDescr) < 0)
+         {
+            Button->Pwm.Connected = false;
+         }
+      }
+      else if (BUTTON_OpenGpio(Button->GpioPin, BUTTON_GPIO_IN, &Button->FileDescr) &&
+               SetGpioEdge(Button->GpioPin, EdgeStr[Button->Edge]))
       {
          ReadGpio();
-         Button->GpioConnected = true;
-         CFE_EVS_SendEvent(BUTTON_CONSTRUCTOR_EID, CFE_EVS_EventType_INFORMATION, 
-                           "Sucessfully connected to GPIO pin %d", Button->GpioPin);
+         OpenQueryFile(Button->GpioPin);
+         if (EVT_ENGINE_AddLine(&Button->EvtEngine, Button->FileDescr) >= 0)
+         {
+            Button->GpioConnected = true;
+            CFE_EVS_SendEvent(BUTTON_CONSTRUCTOR_EID, CFE_EVS_EventType_INFORMATION, 
+                              "Sucessfully connected to GPIO pin %d using the %s event engine", 
+                              Button->GpioPin, EVT_ENGINE_TypeStr(Button->EvtEngine.Type));
+            SHM_EXPORT_Constructor(&Button->ShmExport, INITBL_GetStrConfig(Button->IniTbl, CFG_SHM_EXPORT_NAME));
+            EVENT_MACRO_Constructor(&Button->EventMacro, INITBL_GetStrConfig(Button->IniTbl, CFG_MACRO_TBL_FILE));
+            EVENT_ROUTE_Constructor(&Button->EventRoute, IniTbl, Button->GpioPin, Button->LastRead, &Button->EventMacro);
+         }
       }
-   }
+   
+   } /* End if event engine constructed */
+   
+   CAPTURE_Constructor(&Button->Capture, IniTbl, &Button->EvtEngine, Button->GpioConnected);
+   
+   PublishState();
+   
+   CFE_MSG_Init(CFE_MSG_PTR(Button->SelfTest.Tlm.TelemetryHeader), 
+                CFE_SB_ValueToMsgId(INITBL_GetIntConfig(Button->IniTbl, CFG_RPI_BTN_SELF_TEST_TLM_TOPICID)), 
+                sizeof(RPI_BTN_SelfTestTlm_t));
+   
+   Button->ChildDiag.Enabled = (INITBL_GetIntConfig(Button->IniTbl, CFG_CHILD_DIAG_ENABLE) != 0);
+   CFE_MSG_Init(CFE_MSG_PTR(Button->ChildDiag.Tlm.TelemetryHeader), 
+                CFE_SB_ValueToMsgId(INITBL_GetIntConfig(Button->IniTbl, CFG_RPI_BTN_CHILD_DIAG_TLM_TOPICID)), 
+                sizeof(RPI_BTN_ChildDiagTlm_t));
    
 } /* End BUTTON_Constructor() */
 
@@ -121,7 +222,9 @@ void BUTTON_Constructor(BUTTON_Class_t *ButtonPtr, INITBL_Class_t *IniTbl)
 **
 ** Notes:
 **   1. Returning false causes the child task to terminate.
-**   2. Information events are sent because this is instructional code and the
+**   2. Every mode shares the wait loop. The Mode*() functions dispatch to
+**      the active mode's timeout, edge processing and service functions.
+**   3. Information events are sent because this is instructional code and the
 **      events provide feedback. The events are filtered so they won't flood
 **      the ground. A reset app command resets the event filter.  
 **
@@ -130,23 +233,42 @@ bool BUTTON_ChildTask(CHILDMGR_Class_t* ChildMgr)
 {
    
    bool RetStatus = false;
+   bool WakeRequested = false;
+   int  EdgeCnt;
+   EVT_ENGINE_Edge_t Edges[EDGE_BATCH];
    
-   if (Button->GpioConnected)
+   if (ModeConnected())
    {
-      int Status = poll(Button->PollFileDescr, 1, -1);
-      if ((Status > 0) && (Button->PollFileDescr[0].revents & POLLPRI))
+      
+      EdgeCnt = EVT_ENGINE_Wait(&Button->EvtEngine, Edges, EDGE_BATCH, ModeTimeoutMs(), &WakeRequested);
+      
+      if (EdgeCnt > 0)
       {
-         ButtonPressed();
-         lseek(Button->PollFileDescr[0].fd, 0, SEEK_SET);
-         ReadGpio();
-         CFE_EVS_SendEvent(BUTTON_CHILD_TASK_EID, CFE_EVS_EventType_INFORMATION, 
-                           "Button pressed, read file value %d", Button->LastRead);
+         ModeProcessEdges(Edges, EdgeCnt);
+      }
+      else if (EdgeCnt < 0)
+      {
+         CFE_EVS_SendEvent(BUTTON_CHILD_TASK_EID, CFE_EVS_EventType_ERROR, 
+                           "Child task %s event engine wait failed", 
+                           EVT_ENGINE_TypeStr(Button->EvtEngine.Type));
       }
       
+      ModeService(WakeRequested);
+      
       RetStatus = true;
    
    } /* End if connected */
    
+   if (WakeRequested && atomic_exchange(&Button->ResetRequested, false))
+   {
+      ResetChildStatus();
+   }
+   
+   if (WakeRequested && atomic_exchange(&Button->ChildDiag.SampleRequested, false))
+   {
+      SampleChildDiag();
+   }
+   
    return RetStatus;
 
 
@@ -154,42 +276,44 @@ bool BUTTON_ChildTask(CHILDMGR_Class_t* ChildMgr)
 
 
 /******************************************************************************
-** Function: BUTTON_ResetStatus
+** Function: BUTTON_GetState
 **
-** Reset counters and status flags to a known reset state.
+** Copy a consistent snapshot of the button state.
 **
 ** Notes:
-**   1. Any counter or variable that is reported in status telemetry that
-**      doesn't change the functional behavior should be reset.
+**   1. Sequence lock reader. An odd sequence means a write is in progress
+**      and a changed sequence means the copy may be torn, either case retries.
+**      Writes are a few dozen bytes so retries are rare and short.
 **
 */
-void BUTTON_ResetStatus(void)
+void BUTTON_GetState(BUTTON_State_t *State)
 {
 
-   return;
-
-} /* End BUTTON_ResetStatus() */
-
-
-/******************************************************************************
-**
-** Process a button pressed event
-**
-*/
-static void ButtonPressed(void)
-{
+   unsigned int StartSeq;
+   unsigned int EndSeq;
+   
+   do
+   {
+      StartSeq = atomic_load_explicit(&Button->StateSeq, memory_order_acquire);
+      
+      *State = Button->State;
+      
+      atomic_thread_fence(memory_order_acquire);
+      EndSeq = atomic_load_explicit(&Button->StateSeq, memory_order_relaxed);
    
-   Button->PressedCount++;
+   } while ((StartSeq & 1) || (StartSeq != EndSeq));
    
-} /* End ButtonPressed() */
+} /* End BUTTON_GetState() */
 
 
 /******************************************************************************
+** Function: BUTTON_OpenGpio
 **
-** Attach an interrupt handler to a GPIO pin
+** Notes:
+**   1. See button.h prologue.
 **
 */
-bool OpenGpio(int GpioPin, Direction_t Direction)
+bool BUTTON_OpenGpio(int GpioPin, BUTTON_GpioDir_t Direction, int *FileDescr)
 {
 
    int StrLen;
@@ -202,132 +326,1127 @@ bool OpenGpio(int GpioPin, Direction_t Direction)
       return false;
    }
    
-   if (Direction != DIR_IN && Direction != DIR_OUT)
+   if (Direction != BUTTON_GPIO_IN && Direction != BUTTON_GPIO_OUT)
    {
       CFE_EVS_SendEvent (BUTTON_OPEN_GPIO_EID, CFE_EVS_EventType_ERROR, 
-                         "Invalid direction %d. Value must be %d(in) or %d(out)", Direction, DIR_IN, DIR_OUT);      
+                         "Invalid direction %d. Value must be %d(in) or %d(out)", Direction, BUTTON_GPIO_IN, BUTTON_GPIO_OUT);      
       return false;
    }
    
    // GPIO pin string used for EXPORT operations 
    StrLen = snprintf(StrBuf, RPI_BTN_DEV_STR_MAX, "%d", GpioPin);
-   if (Button->FileDescr != 0)
+   if (*FileDescr != 0)
    {
-      close(Button->FileDescr);
-      Button->FileDescr = open(INITBL_GetStrConfig(Button->IniTbl, CFG_BTN_DEV_STR_UNEXPORT), O_WRONLY);
-      write(Button->FileDescr, StrBuf, StrLen);
-      close(Button->FileDescr);
-      Button->FileDescr = 0;
+      close(*FileDescr);
+      *FileDescr = open(INITBL_GetStrConfig(Button->IniTbl, CFG_BTN_DEV_STR_UNEXPORT), O_WRONLY);
+      write(*FileDescr, StrBuf, StrLen);
+      close(*FileDescr);
+      *FileDescr = 0;
    }
    
-   Button->FileDescr = open(INITBL_GetStrConfig(Button->IniTbl, CFG_BTN_DEV_STR_EXPORT), O_WRONLY);
-   write(Button->FileDescr, StrBuf, StrLen);
-   close(Button->FileDescr);
+   *FileDescr = open(INITBL_GetStrConfig(Button->IniTbl, CFG_BTN_DEV_STR_EXPORT), O_WRONLY);
+   write(*FileDescr, StrBuf, StrLen);
+   close(*FileDescr);
    StrLen = snprintf(StrBuf, RPI_BTN_DEV_STR_MAX,INITBL_GetStrConfig(Button->IniTbl, CFG_BTN_DEV_STR_DIRECTION), GpioPin);
-   Button->FileDescr = open(StrBuf, O_WRONLY);
+   *FileDescr = open(StrBuf, O_WRONLY);
    
-   if (Direction == DIR_OUT)
+   if (Direction == BUTTON_GPIO_OUT)
    {
-      write(Button->FileDescr, DIR_OUT_STR, strlen(DIR_OUT_STR)+1);
-      close(Button->FileDescr);
+      write(*FileDescr, DIR_OUT_STR, strlen(DIR_OUT_STR)+1);
+      close(*FileDescr);
       StrLen = snprintf(StrBuf, RPI_BTN_DEV_STR_MAX, INITBL_GetStrConfig(Button->IniTbl, CFG_BTN_DEV_STR_VALUE), GpioPin);
-      Button->FileDescr = open(StrBuf, O_WRONLY);
+      *FileDescr = open(StrBuf, O_WRONLY);
    } 
    else
    {
-       write(Button->FileDescr, DIR_IN_STR, strlen(DIR_IN_STR)+1);
-       close(Button->FileDescr);
+       write(*FileDescr, DIR_IN_STR, strlen(DIR_IN_STR)+1);
+       close(*FileDescr);
        StrLen = snprintf(StrBuf, RPI_BTN_DEV_STR_MAX, INITBL_GetStrConfig(Button->IniTbl, CFG_BTN_DEV_STR_VALUE), GpioPin);
-       Button->FileDescr = open(StrBuf, O_RDONLY);
+       *FileDescr = open(StrBuf, O_RDONLY);
    }
    
-   return true;
+   return (*FileDescr >= 0);
  
-} /* OpenGpio() */
+} /* End BUTTON_OpenGpio() */
 
 
 /******************************************************************************
+** Function: BUTTON_ReadLevel
 **
-** Read from a GPIO pin
+** Read the current level of the button line.
+**
+** Notes:
+**   1. pread() is used so the query file offset never needs to be restored
+**      with lseek().
 **
 */
-static bool ReadGpio(void)
+bool BUTTON_ReadLevel(int *Level)
 {
 
    char ValueStr[3];
-   int  Status = read(Button->FileDescr, ValueStr, 3);
- 
-   if (Status > 0)
+   bool RetStatus = false;
+   
+   if (Button->GpioConnected && Button->QueryFileDescr > 0)
    {
-      lseek(Button->FileDescr, 0, SEEK_SET);
-      if (ValueStr[0] == '0')
+      if (pread(Button->QueryFileDescr, ValueStr, sizeof(ValueStr), 0) > 0)
       {
-         Button->LastRead = 0;
+         *Level = (ValueStr[0] == '0') ? 0 : 1;
+         RetStatus = true;
       }
       else
       {
-         Button->LastRead = 1;
+         CFE_EVS_SendEvent (BUTTON_READ_LEVEL_EID, CFE_EVS_EventType_ERROR, 
+                            "Failed to read level of GPIO pin %d", Button->GpioPin);
       }
    }
+   else
+   {
+      CFE_EVS_SendEvent (BUTTON_READ_LEVEL_EID, CFE_EVS_EventType_ERROR, 
+                         "Read level failed, GPIO pin %d is not connected", Button->GpioPin);
+   }
    
-   return true;
-   
-} /* ReadGpio() */
+   return RetStatus;
+
+} /* End BUTTON_ReadLevel() */
 
 
 /******************************************************************************
+** Function: BUTTON_RequestChildDiag
 **
-** Set which edge will trigger interrupt: rising, falling, both
+** Notes:
+**   1. See button.h prologue.
 **
 */
-static bool SetGpioEdge(int GpioPin, const char *Edge) 
+void BUTTON_RequestChildDiag(void)
 {
 
-   char StrBuf[RPI_BTN_DEV_STR_MAX];
-   int FileDescr;
+   if (Button->ChildDiag.Enabled && ModeConnected())
+   {
+      atomic_store(&Button->ChildDiag.SampleRequested, true);
+      EVT_ENGINE_Wake(&Button->EvtEngine);
+   }
+
+} /* End BUTTON_RequestChildDiag() */
+
+
+/******************************************************************************
+** Function: BUTTON_StartSelfTestCmd
+**
+** Start a loopback latency self-test.
+**
+** Notes:
+**   1. The self-test output is opened by the first start command so the
+**      output pin isn't driven unless a self-test is run.
+**
+*/
+bool BUTTON_StartSelfTestCmd(void* DataObjPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+
+   const RPI_BTN_StartSelfTest_CmdPayload_t *Cmd = CMDMGR_PAYLOAD_PTR(MsgPtr, RPI_BTN_StartSelfTest_t);
+   BUTTON_SelfTest_t *SelfTest = &Button->SelfTest;
    bool RetStatus = false;
    
-   snprintf(StrBuf, RPI_BTN_DEV_STR_MAX, INITBL_GetStrConfig(Button->IniTbl, CFG_BTN_DEV_STR_EDGE), GpioPin);
-   FileDescr = open(StrBuf, O_WRONLY);
-   if (FileDescr >= 0)
+   if (!Button->GpioConnected)
    {
-      write(FileDescr, Edge, strlen(Edge)+1);
-      close(FileDescr);
-      RetStatus = true;
+      CFE_EVS_SendEvent(BUTTON_SELF_TEST_EID, CFE_EVS_EventType_ERROR, 
+                        "Self-test rejected, GPIO pin %d is not connected", Button->GpioPin);
    }
-   else
+   else if (atomic_load(&SelfTest->Running))
    {
-      CFE_EVS_SendEvent (BUTTON_SET_EDGE_EID, CFE_EVS_EventType_ERROR, 
-                         "Failed to set edge %s to '%s'", StrBuf, Edge);         
+      CFE_EVS_SendEvent(BUTTON_SELF_TEST_EID, CFE_EVS_EventType_ERROR, 
+                        "Self-test rejected, a self-test is already running");
+   }
+   else if ((Cmd->Toggles < 1) || (Cmd->Toggles > RPI_BTN_SELF_TEST_MAX_SAMPLES))
+   {
+      CFE_EVS_SendEvent(BUTTON_SELF_TEST_EID, CFE_EVS_EventType_ERROR, 
+                        "Self-test rejected, invalid toggles %d. Valid range [1..%d]", 
+                        Cmd->Toggles, RPI_BTN_SELF_TEST_MAX_SAMPLES);
+   }
+   else if ((Cmd->RateHz < 1) || (Cmd->RateHz > RPI_BTN_SELF_TEST_MAX_RATE_HZ))
+   {
+      CFE_EVS_SendEvent(BUTTON_SELF_TEST_EID, CFE_EVS_EventType_ERROR, 
+                        "Self-test rejected, invalid rate %dHz. Valid range [1..%d]", 
+                        Cmd->RateHz, RPI_BTN_SELF_TEST_MAX_RATE_HZ);
+   }
+   else if (OpenSelfTestOutput())
+   {
+      
+      SelfTest->Toggles = Cmd->Toggles;
+      SelfTest->RateHz  = Cmd->RateHz;
+      atomic_store(&SelfTest->Running, true);
+      EVT_ENGINE_Wake(&Button->EvtEngine);
+      
+      CFE_EVS_SendEvent(BUTTON_SELF_TEST_EID, CFE_EVS_EventType_INFORMATION, 
+                        "Self-test started with %d toggles at %dHz", Cmd->Toggles, Cmd->RateHz);
+      RetStatus = true;
+   
    }
    
    return RetStatus;
 
-} /* End SetGpioEdge() */
+} /* End BUTTON_StartSelfTestCmd() */
 
 
 /******************************************************************************
+** Function: BUTTON_UpdatePressRates
+**
+** Update the sliding window press rates.
 **
-** Write to button GPIO pin
+** Notes:
+**   1. The bucket being overwritten is the one that leaves the 60 second
+**      window and the bucket written 10 updates ago leaves the 10 second
+**      window.
+**   2. Until a window has been filled the rate is averaged over the
+**      number of seconds available.
 **
 */
-/*
-static bool WriteGpio(int Bit)
+void BUTTON_UpdatePressRates(void)
+{
+
+   BUTTON_PressRate_t *PressRate = &Button->PressRate;
+   BUTTON_State_t State;
+   uint32 Presses;
+   uint32 MidWinIdx;
+   uint32 Divisor;
+   
+   BUTTON_GetState(&State);
+   
+   Presses = State.PressCnt - PressRate->LastPressCnt;
+   PressRate->LastPressCnt = State.PressCnt;
+   
+   PressRate->BucketIdx = (PressRate->BucketIdx + 1) % BUTTON_RATE_BUCKETS;
+   MidWinIdx = (PressRate->BucketIdx + BUTTON_RATE_BUCKETS - BUTTON_RATE_WIN_MID) % BUTTON_RATE_BUCKETS;
+   
+   PressRate->Sum60s += Presses - PressRate->Bucket[PressRate->BucketIdx];
+   PressRate->Sum10s += Presses - PressRate->Bucket[MidWinIdx];
+   PressRate->Bucket[PressRate->BucketIdx] = Presses;
+   
+   if (PressRate->BucketsFilled < BUTTON_RATE_BUCKETS)
+   {
+      PressRate->BucketsFilled++;
+   }
+   
+   PressRate->Rate1s = (float)Presses;
+   
+   Divisor = (PressRate->BucketsFilled < BUTTON_RATE_WIN_MID) ? PressRate->BucketsFilled : BUTTON_RATE_WIN_MID;
+   PressRate->Rate10s = (float)PressRate->Sum10s / (float)Divisor;
+   PressRate->Rate60s = (float)PressRate->Sum60s / (float)PressRate->BucketsFilled;
+
+} /* End BUTTON_UpdatePressRates() */
+
+
+/******************************************************************************
+** Function: BUTTON_ResetStatus
+**
+** Reset counters and status flags to a known reset state.
+**
+** Notes:
+**   1. Any counter or variable that is reported in status telemetry that
+**      doesn't change the functional behavior should be reset.
+**   2. The counters are owned by the child task so the reset is handed off
+**      to it, see ResetChildStatus().
+**
+*/
+void BUTTON_ResetStatus(void)
+{
+
+   if (ModeConnected())
+   {
+      atomic_store(&Button->ResetRequested, true);
+      EVT_ENGINE_Wake(&Button->EvtEngine);
+   }
+
+} /* End BUTTON_ResetStatus() */
+
+
+/******************************************************************************
+**
+** Process a button pressed event
+**
+** Notes:
+**   1. PressedCount counts every edge. PressCnt only counts the edges that
+**      start a press, with both edges enabled that's the edge to the active
+**      level, with a single edge type every edge is one press.
+**   2. Only updates the CDS data block. The caller copies it to the CDS
+**      once per batch of edges so a burst costs one copy and CRC, a reset
+**      can only lose the edges of the batch being processed.
+**
+*/
+static void ButtonPressed(void)
+{
+   
+   BUTTON_CdsData_t  *CdsData = &Button->CdsData;
+   BUTTON_EdgeHist_t *EdgeHist = &CdsData->EdgeHist[CdsData->EdgeHistIdx];
+   
+   if (!Button->SelfTest.Active)
+   {
+      CdsData->PressedCount++;
+      if ((EDGE_MODE() != RPI_BTN_EDGE_BOTH) || (Button->LastRead == Button->ActiveLevel))
+      {
+         Button->PressCnt++;
+      }
+   }
+   
+   EdgeHist->Time  = Button->LastEdgeTime;
+   EdgeHist->Level = Button->LastRead;
+   CdsData->EdgeHistIdx = (CdsData->EdgeHistIdx + 1) % RPI_BTN_CDS_EDGE_HIST_LEN;
+   
+} /* End ButtonPressed() */
+
+
+/******************************************************************************
+**
+** Process a batch of button line edges
+**
+*/
+static void ButtonProcessEdges(const EVT_ENGINE_Edge_t *Edges, int EdgeCnt)
 {
+
+   uint64 DetectNs = GPIO_CDEV_NowNs();
+   int i;
    
-   if (Bit == 0) 
+   Button->LastEdgeTime = CFE_TIME_GetTime();
+   for (i=0; i < EdgeCnt; i++)
    {
-      write(Button->FileDescr, "0", 1);
-      Button->LastWrite = 0;
+      SequenceEdge(EDGE_LEVEL(&Edges[i]));
+      Button->LastRead = EDGE_LEVEL(&Edges[i]);
+      ButtonPressed();
+      SHM_EXPORT_AddEdge(&Button->ShmExport, Button->EdgeSeq, DetectNs, Button->LastRead);
+      if (!Button->SelfTest.Active)
+      {
+         EVENT_ROUTE_Edge(&Button->EventRoute, Button->EdgeSeq, Button->LastRead,
+                          DetectNs, Button->CdsData.PressedCount);
+         CAPTURE_Edge(&Button->Capture, Button->EdgeSeq, Button->LastRead, DetectNs);
+      }
    }
-   else 
+   if (Button->CdsEnabled)
    {
-      write(Button->FileDescr, "1", 1);
-      Button->LastWrite = 1;
+      CFE_ES_CopyToCDS(Button->CdsHandle, &Button->CdsData);
    }
    
-   lseek(Button->FileDescr, 0, SEEK_SET);
- 
-   return true;
+   if (Button->SelfTest.Active)
+   {
+      SelfTestEdge(DetectNs);
+   }
+   else
+   {
+      CFE_EVS_SendEvent(BUTTON_CHILD_TASK_EID, CFE_EVS_EventType_INFORMATION, 
+                        "Button pressed, read file value %d", Button->LastRead);
+   }
+
+} /* End ButtonProcessEdges() */
+
+
+/******************************************************************************
+**
+** Run the button mode work that follows every wait
+**
+*/
+static void ButtonService(bool WakeRequested)
+{
+
+   if (Button->SelfTest.Active || (WakeRequested && atomic_load(&Button->SelfTest.Running)))
+   {
+      SelfTestExecute();
+   }
+   
+   CAPTURE_Service(&Button->Capture, GPIO_CDEV_NowNs());
+   
+   PublishState();
+
+} /* End ButtonService() */
+
+
+/******************************************************************************
+**
+** Return the button mode child task wait timeout in milliseconds, -1 waits
+** for an edge or a wake request
+**
+*/
+static int ButtonTimeoutMs(void)
+{
+
+   int TimeoutMs = SelfTestTimeoutMs();
+   int CaptureMs = CAPTURE_TimeoutMs(&Button->Capture, GPIO_CDEV_NowNs());
+   
+   if (CaptureMs >= 0 && (TimeoutMs < 0 || CaptureMs < TimeoutMs))
+   {
+      TimeoutMs = CaptureMs;
+   }
+   
+   return TimeoutMs;
+
+} /* End ButtonTimeoutMs() */
+
+
+/******************************************************************************
+**
+** Publish the child task's working state for the main task
+**
+** Notes:
+**   1. Sequence lock writer, the child task is the only writer after
+**      construction so no writer-side locking is required.
+**
+*/
+static void PublishState(void)
+{
+
+   unsigned int Seq = atomic_load_explicit(&Button->StateSeq, memory_order_relaxed);
+   
+   atomic_store_explicit(&Button->StateSeq, Seq + 1, memory_order_relaxed);
+   atomic_thread_fence(memory_order_release);
+   
+   Button->State.GpioConnected = Button->GpioConnected;
+   Button->State.GpioPin       = Button->GpioPin;
+   Button->State.PressedCount  = Button->CdsData.PressedCount;
+   Button->State.PressCnt      = Button->PressCnt;
+   Button->State.LastRead      = Button->LastRead;
+   Button->State.LastWrite     = Button->LastWrite;
+   Button->State.LastEdgeTime  = Button->LastEdgeTime;
+   
+   Button->State.EventEngine     = Button->EvtEngine.Type;
+   Button->State.ChildWakeCnt    = Button->EvtEngine.WakeCnt;
+   Button->State.ChildSyscallCnt = Button->EvtEngine.SyscallCnt;
+   
+   Button->State.EdgeSeq       = Button->EdgeSeq;
+   Button->State.SourceLostCnt = Button->SourceLostCnt;
+   Button->State.EngineLostCnt = Button->EngineLostCnt;
+   Button->State.ExportLostCnt = Button->ShmExport.OverrunCnt;
+   Button->State.SbLostCnt     = Button->EventRoute.SendErrCnt + Button->EventMacro.SendErrCnt;
+   Button->State.MacroSentCnt  = Button->EventMacro.SentCnt;
+   
+   atomic_store_explicit(&Button->StateSeq, Seq + 2, memory_order_release);
+
+   SHM_EXPORT_Publish(&Button->ShmExport, Button->GpioConnected, Button->GpioPin,
+                      Button->CdsData.PressedCount, Button->LastRead);
+
+} /* End PublishState() */
+
+
+/******************************************************************************
+**
+** Reset the child task's status counters for BUTTON_ResetStatus()
+**
+** Notes:
+**   1. EngineLostCnt is the part of the event engine's loss counts already
+**      sequenced so it's reset with them. EdgeSeq and PressedCount aren't
+**      reset because they're functional and persisted.
+**   2. The child diagnostics deltas are taken from the engine counters so
+**      the next sample only primes them.
+**
+*/
+static void ResetChildStatus(void)
+{
+
+   Button->SourceLostCnt = 0;
+   Button->EngineLostCnt = 0;
+   EVT_ENGINE_ResetStatus(&Button->EvtEngine);
+   Button->ChildDiag.Primed = false;
+   
+   SHM_EXPORT_ResetStatus(&Button->ShmExport);
+   EVENT_ROUTE_ResetStatus(&Button->EventRoute);
+   EVENT_MACRO_ResetStatus(&Button->EventMacro);
+   
+   KEYPAD_ResetStatus(&Button->Keypad);
+   ENCODER_ResetStatus(&Button->Encoder);
+   PULSE_ResetStatus(&Button->Pulse);
+   PWM_ResetStatus(&Button->Pwm);
+   
+   if (Button->Mode == BUTTON_MODE_BUTTON)
+   {
+      PublishState();
+   }
+
+} /* End ResetChildStatus() */
+
+
+/******************************************************************************
+**
+** Sample the child task's resource usage and send diagnostics telemetry
+**
+** Notes:
+**   1. Must be called from the child task, RUSAGE_THREAD reports the
+**      calling thread.
+**   2. Values are the change since the previous sample so they cover one
+**      sample interval.
+**
+*/
+static void SampleChildDiag(void)
+{
+
+   BUTTON_ChildDiag_t *ChildDiag = &Button->ChildDiag;
+   RPI_BTN_ChildDiagTlm_Payload_t *Payload = &ChildDiag->Tlm.Payload;
+   EVT_ENGINE_Class_t *EvtEngine = &Button->EvtEngine;
+   struct rusage Usage;
+   uint64 NowNs = GPIO_CDEV_NowNs();
+   uint64 UserCpuUs;
+   uint64 SysCpuUs;
+   uint64 IntervalUs;
+   
+   if (getrusage(RUSAGE_THREAD, &Usage) == 0)
+   {
+   
+      UserCpuUs = (uint64)Usage.ru_utime.tv_sec * 1000000 + Usage.ru_utime.tv_usec;
+      SysCpuUs  = (uint64)Usage.ru_stime.tv_sec * 1000000 + Usage.ru_stime.tv_usec;
+      
+      if (ChildDiag->Primed)
+      {
+         
+         IntervalUs = (NowNs - ChildDiag->LastNs) / 1000;
+         if (IntervalUs == 0)
+         {
+            IntervalUs = 1;
+         }
+         
+         Payload->IntervalMs  = IntervalUs / 1000;
+         Payload->UserCpuUs   = UserCpuUs - ChildDiag->LastUserCpuUs;
+         Payload->SysCpuUs    = SysCpuUs  - ChildDiag->LastSysCpuUs;
+         Payload->CpuPct      = 100.0 * (float)(Payload->UserCpuUs + Payload->SysCpuUs) / (float)IntervalUs;
+         Payload->VolCtxSw    = (uint64)Usage.ru_nvcsw  - ChildDiag->LastVolCtxSw;
+         Payload->InvolCtxSw  = (uint64)Usage.ru_nivcsw - ChildDiag->LastInvolCtxSw;
+         Payload->Wakes       = EvtEngine->WakeCnt    - ChildDiag->LastWakeCnt;
+         Payload->WakesPerSec = (float)Payload->Wakes * 1000000.0 / (float)IntervalUs;
+         Payload->Edges       = EvtEngine->EdgeCnt    - ChildDiag->LastEdgeCnt;
+         Payload->Syscalls    = EvtEngine->SyscallCnt - ChildDiag->LastSyscallCnt;
+         
+         CFE_SB_TimeStampMsg(CFE_MSG_PTR(ChildDiag->Tlm.TelemetryHeader));
+         CFE_SB_TransmitMsg(CFE_MSG_PTR(ChildDiag->Tlm.TelemetryHeader), true);
+      
+      } /* End if primed */
+      
+      ChildDiag->Primed         = true;
+      ChildDiag->LastNs         = NowNs;
+      ChildDiag->LastUserCpuUs  = UserCpuUs;
+      ChildDiag->LastSysCpuUs   = SysCpuUs;
+      ChildDiag->LastVolCtxSw   = Usage.ru_nvcsw;
+      ChildDiag->LastInvolCtxSw = Usage.ru_nivcsw;
+      ChildDiag->LastWakeCnt    = EvtEngine->WakeCnt;
+      ChildDiag->LastEdgeCnt    = EvtEngine->EdgeCnt;
+      ChildDiag->LastSyscallCnt = EvtEngine->SyscallCnt;
+   
+   } /* End if getrusage */
+   else
+   {
+      CFE_EVS_SendEvent(BUTTON_CHILD_TASK_EID, CFE_EVS_EventType_ERROR, 
+                        "Child task diagnostics getrusage() failed, disabling diagnostics");
+      ChildDiag->Enabled = false;
+   }
+
+} /* End SampleChildDiag() */
+
+
+/******************************************************************************
+**
+** Assign the next sequence number to an edge read at Level
+**
+** Notes:
+**   1. Edges the event engine lost since the previous edge are attributed to
+**      the engine. Otherwise a repeated level with both edges enabled means
+**      sysfs coalesced at least one edge before the value file was read.
+**   2. Must be called before LastRead is updated with Level.
+**
+*/
+static void SequenceEdge(int Level)
+{
+
+   uint32 EngineLostCnt = Button->EvtEngine.MergedCnt + Button->EvtEngine.OverrunCnt;
+   uint32 LostCnt = EngineLostCnt - Button->EngineLostCnt;
+   
+   Button->EngineLostCnt = EngineLostCnt;
+   
+   if ((LostCnt == 0) && (EDGE_MODE() == RPI_BTN_EDGE_BOTH) && (Level == Button->LastRead))
+   {
+      LostCnt = 1;
+      Button->SourceLostCnt++;
+   }
+   
+   Button->EdgeSeq += LostCnt + 1;
+
+} /* End SequenceEdge() */
+
+
+/******************************************************************************
+**
+** Open the file that drives the self-test loopback
+**
+** Notes:
+**   1. 'wired' opens SELF_TEST_OUT_PIN as an output that must be wired to
+**      the button pin.
+**   2. 'simulated' opens SELF_TEST_DEV_STR_SIM for the button pin. It's
+**      intended for a simulated GPIO chip whose file sets the input level
+**      and generates an edge, e.g. gpio-mockup's debugfs event files.
+**
+*/
+static bool OpenSelfTestOutput(void)
+{
+
+   BUTTON_SelfTest_t *SelfTest = &Button->SelfTest;
+   const char *Loopback = INITBL_GetStrConfig(Button->IniTbl, CFG_SELF_TEST_LOOPBACK);
+   char StrBuf[RPI_BTN_DEV_STR_MAX];
+   
+   if (SelfTest->OutFileDescr <= 0)
+   {
+      
+      if (strcmp(Loopback, SELF_TEST_WIRED_STR) == 0)
+      {
+         if (!BUTTON_OpenGpio(INITBL_GetIntConfig(Button->IniTbl, CFG_SELF_TEST_OUT_PIN), BUTTON_GPIO_OUT, &SelfTest->OutFileDescr))
+         {
+            CFE_EVS_SendEvent(BUTTON_SELF_TEST_EID, CFE_EVS_EventType_ERROR, 
+                              "Self-test failed to open output GPIO pin %d",
+                              INITBL_GetIntConfig(Button->IniTbl, CFG_SELF_TEST_OUT_PIN));
+         }
+      }
+      else if (strcmp(Loopback, SELF_TEST_SIMULATED_STR) == 0)
+      {
+         snprintf(StrBuf, RPI_BTN_DEV_STR_MAX, INITBL_GetStrConfig(Button->IniTbl, CFG_SELF_TEST_DEV_STR_SIM), Button->GpioPin);
+         SelfTest->OutFileDescr = open(StrBuf, O_WRONLY);
+         if (SelfTest->OutFileDescr < 0)
+         {
+            CFE_EVS_SendEvent(BUTTON_SELF_TEST_EID, CFE_EVS_EventType_ERROR, 
+                              "Self-test failed to open simulated input file %s", StrBuf);
+         }
+      }
+      else
+      {
+         CFE_EVS_SendEvent(BUTTON_SELF_TEST_EID, CFE_EVS_EventType_ERROR, 
+                           "Self-test loopback '%s' is not '%s' or '%s'",
+                           Loopback, SELF_TEST_WIRED_STR, SELF_TEST_SIMULATED_STR);
+      }
+   
+   } /* End if not open */
+   
+   return (SelfTest->OutFileDescr > 0);
+
+} /* End OpenSelfTestOutput() */
+
+
+/******************************************************************************
+**
+** Compare function for sorting latencies
+**
+*/
+static int CompareLatency(const void *A, const void *B)
+{
+
+   uint32 LatencyA = *(const uint32 *)A;
+   uint32 LatencyB = *(const uint32 *)B;
+   
+   return (LatencyA > LatencyB) - (LatencyA < LatencyB);
+
+} /* End CompareLatency() */
+
+
+/******************************************************************************
+**
+** Compute the self-test statistics and send the self-test telemetry packet
+**
+** Notes:
+**   1. Percentiles use the nearest-rank method on the sorted samples.
+**
+*/
+static void SelfTestComplete(void)
+{
+
+   BUTTON_SelfTest_t *SelfTest = &Button->SelfTest;
+   RPI_BTN_SelfTestTlm_Payload_t *Payload = &SelfTest->Tlm.Payload;
+   uint16 HistBins = sizeof(Payload->Hist)/sizeof(Payload->Hist[0]);
+   uint16 Detected = SelfTest->DetectedCnt;
+   uint64 Sum = 0;
+   uint32 Latency;
+   uint16 Bin;
+   uint16 i;
+   
+   memset(Payload, 0, sizeof(RPI_BTN_SelfTestTlm_Payload_t));
+   Payload->Toggles  = SelfTest->ToggleCnt;
+   Payload->RateHz   = SelfTest->RateHz;
+   Payload->Detected = Detected;
+   Payload->Missed   = SelfTest->MissedCnt;
+   
+   if (Detected > 0)
+   {
+      
+      qsort(SelfTest->LatencyUs, Detected, sizeof(SelfTest->LatencyUs[0]), CompareLatency);
+      
+      for (i=0; i < Detected; i++)
+      {
+         Latency = SelfTest->LatencyUs[i];
+         Sum += Latency;
+         for (Bin=0; (Latency >>= 1) != 0 && Bin < (HistBins-1); Bin++);
+         Payload->Hist[Bin]++;
+      }
+      
+      Payload->MinUs  = SelfTest->LatencyUs[0];
+      Payload->MaxUs  = SelfTest->LatencyUs[Detected-1];
+      Payload->MeanUs = Sum / Detected;
+      Payload->P50Us  = SelfTest->LatencyUs[((Detected * 50 + 99) / 100) - 1];
+      Payload->P90Us  = SelfTest->LatencyUs[((Detected * 90 + 99) / 100) - 1];
+      Payload->P99Us  = SelfTest->LatencyUs[((Detected * 99 + 99) / 100) - 1];
+   
+   } /* End if detected */
+   
+   CFE_SB_TimeStampMsg(CFE_MSG_PTR(SelfTest->Tlm.TelemetryHeader));
+   CFE_SB_TransmitMsg(CFE_MSG_PTR(SelfTest->Tlm.TelemetryHeader), true);
+   
+   CFE_EVS_SendEvent(BUTTON_SELF_TEST_EID, CFE_EVS_EventType_INFORMATION, 
+                     "Self-test complete: %d of %d detected, latency min %u, p50 %u, p99 %u, max %u usec",
+                     Detected, SelfTest->ToggleCnt, (unsigned int)Payload->MinUs, (unsigned int)Payload->P50Us,
+                     (unsigned int)Payload->P99Us, (unsigned int)Payload->MaxUs);
+   
+   SelfTest->Active = false;
+   atomic_store(&SelfTest->Running, false);
+   
+} /* End SelfTestComplete() */
+
+
+/******************************************************************************
+**
+** Record the latency of a detected self-test edge
+**
+** Notes:
+**   1. Called after the edge has been processed by the child task so the
+**      latency includes the complete edge path.
+**   2. Only the first edge after a toggle is measured, any others such as
+**      bounces are ignored.
+**
+*/
+static void SelfTestEdge(uint64 DetectNs)
+{
+
+   BUTTON_SelfTest_t *SelfTest = &Button->SelfTest;
+   
+   if (SelfTest->AwaitingEdge)
+   {
+      SelfTest->LatencyUs[SelfTest->DetectedCnt++] = (uint32)((DetectNs - SelfTest->WriteNs) / 1000);
+      SelfTest->AwaitingEdge = false;
+   }
+
+} /* End SelfTestEdge() */
+
+
+/******************************************************************************
+**
+** Start a requested self-test and toggle the output when a toggle is due
+**
+** Notes:
+**   1. A toggle that isn't detected before the next toggle is counted as
+**      missed. The test completes one period after the last toggle.
+**   2. The output starts at the current input level so every toggle
+**      produces an edge.
+**
+*/
+static void SelfTestExecute(void)
+{
+
+   BUTTON_SelfTest_t *SelfTest = &Button->SelfTest;
+   uint64 NowNs = GPIO_CDEV_NowNs();
+   
+   if (!SelfTest->Active)
+   {
+      SelfTest->Active       = true;
+      SelfTest->AwaitingEdge = false;
+      SelfTest->OutLevel     = Button->LastRead;
+      SelfTest->ToggleCnt    = 0;
+      SelfTest->DetectedCnt  = 0;
+      SelfTest->MissedCnt    = 0;
+      SelfTest->PeriodNs     = 1000000000ULL / SelfTest->RateHz;
+      SelfTest->NextToggleNs = NowNs;
+   }
+   
+   if (NowNs >= SelfTest->NextToggleNs)
+   {
+   
+      if (SelfTest->AwaitingEdge)
+      {
+         SelfTest->MissedCnt++;
+         SelfTest->AwaitingEdge = false;
+      }
+      
+      if (SelfTest->ToggleCnt < SelfTest->Toggles)
+      {
+         SelfTest->OutLevel = !SelfTest->OutLevel;
+         SelfTest->ToggleCnt++;
+         SelfTest->NextToggleNs += SelfTest->PeriodNs;
+         SelfTest->WriteNs = GPIO_CDEV_NowNs();
+         if (WriteGpio(SelfTest->OutFileDescr, SelfTest->OutLevel))
+         {
+            SelfTest->AwaitingEdge = true;
+         }
+         else
+         {
+            SelfTest->MissedCnt++;
+         }
+      }
+      else
+      {
+         SelfTestComplete();
+      }
+   
+   } /* End if toggle due */
+
+} /* End SelfTestExecute() */
+
+
+/******************************************************************************
+**
+** Return the event engine wait timeout in milliseconds
+**
+** Notes:
+**   1. Wait indefinitely unless a self-test is active. The timeout is
+**      rounded up so the child task never wakes before a toggle is due.
+**
+*/
+static int SelfTestTimeoutMs(void)
+{
+
+   BUTTON_SelfTest_t *SelfTest = &Button->SelfTest;
+   uint64 NowNs;
+   int TimeoutMs = -1;
+   
+   if (SelfTest->Active)
+   {
+      NowNs = GPIO_CDEV_NowNs();
+      TimeoutMs = 0;
+      if (SelfTest->NextToggleNs > NowNs)
+      {
+         TimeoutMs = (int)((SelfTest->NextToggleNs - NowNs + 999999) / 1000000);
+      }
+   }
+   
+   return TimeoutMs;
+
+} /* End SelfTestTimeoutMs() */
+
+
+/******************************************************************************
+**
+** Register the Critical Data Store block and restore its contents if it
+** already exists
+**
+** Notes:
+**   1. A CDS restore failure, typically a CRC mismatch, reinitializes the
+**      block to zero.
+**   2. The app continues without persistence if the CDS can't be registered.
+**
+*/
+static void InitCds(void)
+{
+
+   BUTTON_CdsData_t *CdsData = &Button->CdsData;
+   int32 Status;
+   uint32 LastIdx;
+   
+   Status = CFE_ES_RegisterCDS(&Button->CdsHandle, sizeof(BUTTON_CdsData_t), RPI_BTN_CDS_NAME);
+   
+   if (Status == CFE_ES_CDS_ALREADY_EXISTS)
+   {
+      
+      Button->CdsEnabled = true;
+      Status = CFE_ES_RestoreFromCDS(CdsData, Button->CdsHandle);
+      
+      if ((Status == CFE_SUCCESS) && (CdsData->EdgeHistIdx < RPI_BTN_CDS_EDGE_HIST_LEN))
+      {
+         LastIdx = (CdsData->EdgeHistIdx + RPI_BTN_CDS_EDGE_HIST_LEN - 1) % RPI_BTN_CDS_EDGE_HIST_LEN;
+         Button->LastEdgeTime = CdsData->EdgeHist[LastIdx].Time;
+         CFE_EVS_SendEvent(BUTTON_CDS_EID, CFE_EVS_EventType_INFORMATION, 
+                           "Restored button data from CDS, pressed count %u", (unsigned int)CdsData->PressedCount);
+      }
+      else
+      {
+         memset(CdsData, 0, sizeof(BUTTON_CdsData_t));
+         CFE_ES_CopyToCDS(Button->CdsHandle, CdsData);
+         CFE_EVS_SendEvent(BUTTON_CDS_EID, CFE_EVS_EventType_ERROR, 
+                           "Failed to restore button data from CDS, status = 0x%08X. Data reset to zero",
+                           (unsigned int)Status);
+      }
+   
+   } /* End if CDS exists */
+   else if (Status == CFE_SUCCESS)
+   {
+      
+      Button->CdsEnabled = true;
+      CFE_ES_CopyToCDS(Button->CdsHandle, CdsData);
+      
+   }
+   else
+   {
+      
+      CFE_EVS_SendEvent(BUTTON_CDS_EID, CFE_EVS_EventType_ERROR, 
+                        "Failed to register CDS %s, status = 0x%08X. Button data won't persist across resets",
+                        RPI_BTN_CDS_NAME, (unsigned int)Status);
+   }
+   
+} /* End InitCds() */
+
+
+/******************************************************************************
+**
+** Convert an ini file mode string to a mode
+**
+** Notes:
+**   1. An invalid mode string defaults to a single button.
+**
+*/
+static BUTTON_Mode_t ModeStrToMode(const char *Mode)
+{
+
+   BUTTON_Mode_t RetMode = BUTTON_MODE_BUTTON;
+   
+   if (strcmp(Mode, BUTTON_MODE_KEYPAD_STR) == 0)
+   {
+      RetMode = BUTTON_MODE_KEYPAD;
+   }
+   else if (strcmp(Mode, BUTTON_MODE_ENCODER_STR) == 0)
+   {
+      RetMode = BUTTON_MODE_ENCODER;
+   }
+   else if (strcmp(Mode, BUTTON_MODE_PULSE_STR) == 0)
+   {
+      RetMode = BUTTON_MODE_PULSE;
+   }
+   else if (strcmp(Mode, BUTTON_MODE_PWM_STR) == 0)
+   {
+      RetMode = BUTTON_MODE_PWM;
+   }
+   else if (strcmp(Mode, BUTTON_MODE_BUTTON_STR) != 0)
+   {
+      CFE_EVS_SendEvent(BUTTON_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR, 
+                        "Invalid mode '%s', using '%s'", Mode, BUTTON_MODE_BUTTON_STR);         
+   }
+   
+   return RetMode;
+
+} /* End ModeStrToMode() */
+
+
+/******************************************************************************
+**
+** Return true if the active mode's inputs are connected
+**
+*/
+static bool ModeConnected(void)
+{
+
+   bool Connected = false;
+   
+   switch (Button->Mode)
+   {
+      case BUTTON_MODE_BUTTON:  Connected = Button->GpioConnected;     break;
+      case BUTTON_MODE_KEYPAD:  Connected = Button->Keypad.Connected;  break;
+      case BUTTON_MODE_ENCODER: Connected = Button->Encoder.Connected; break;
+      case BUTTON_MODE_PULSE:   Connected = Button->Pulse.Connected;   break;
+      case BUTTON_MODE_PWM:     Connected = Button->Pwm.Connected;     break;
+   }
+   
+   return Connected;
+
+} /* End ModeConnected() */
+
+
+/******************************************************************************
+**
+** Process the edges returned by an event engine wait
+**
+** Notes:
+**   1. The character device modes read their own event files so the edges
+**      only indicate which files are ready. The keypad is scanned and
+**      never has edges.
+**
+*/
+static void ModeProcessEdges(const EVT_ENGINE_Edge_t *Edges, int EdgeCnt)
+{
+
+   switch (Button->Mode)
+   {
+      case BUTTON_MODE_BUTTON:  ButtonProcessEdges(Edges, EdgeCnt);       break;
+      case BUTTON_MODE_KEYPAD:                                            break;
+      case BUTTON_MODE_ENCODER: ENCODER_ProcessEvents(&Button->Encoder);  break;
+      case BUTTON_MODE_PULSE:   PULSE_ProcessEvents(&Button->Pulse);      break;
+      case BUTTON_MODE_PWM:     PWM_ProcessEvents(&Button->Pwm);          break;
+   }
+
+} /* End ModeProcessEdges() */
+
+
+/******************************************************************************
+**
+** Run the active mode's work that follows every wait
+**
+*/
+static void ModeService(bool WakeRequested)
+{
+
+   switch (Button->Mode)
+   {
+      case BUTTON_MODE_BUTTON:  ButtonService(WakeRequested);       break;
+      case BUTTON_MODE_KEYPAD:  KEYPAD_Scan(&Button->Keypad);       break;
+      case BUTTON_MODE_ENCODER: ENCODER_SendTlm(&Button->Encoder);  break;
+      case BUTTON_MODE_PULSE:   PULSE_SendTlm(&Button->Pulse);      break;
+      case BUTTON_MODE_PWM:     PWM_SendTlm(&Button->Pwm);          break;
+   }
+
+} /* End ModeService() */
+
+
+/******************************************************************************
+**
+** Return the active mode's child task wait timeout in milliseconds, -1 waits
+** for an edge or a wake request
+**
+*/
+static int ModeTimeoutMs(void)
+{
+
+   int TimeoutMs = -1;
+   
+   switch (Button->Mode)
+   {
+      case BUTTON_MODE_BUTTON:  TimeoutMs = ButtonTimeoutMs();                     break;
+      case BUTTON_MODE_KEYPAD:  TimeoutMs = KEYPAD_TimeoutMs(&Button->Keypad);     break;
+      case BUTTON_MODE_ENCODER: TimeoutMs = ENCODER_TimeoutMs(&Button->Encoder);   break;
+      case BUTTON_MODE_PULSE:   TimeoutMs = PULSE_TimeoutMs(&Button->Pulse);       break;
+      case BUTTON_MODE_PWM:     TimeoutMs = PWM_TimeoutMs(&Button->Pwm);           break;
+   }
+   
+   return TimeoutMs;
+
+} /* End ModeTimeoutMs() */
+
+
+/******************************************************************************
+**
+** Open a second read-only descriptor to the GPIO value file for on-demand
+** queries from the main task. sysfs tracks poll notifications per open file
+** so reads on this descriptor don't interfere with the child task's poll().
+**
+*/
+static void OpenQueryFile(int GpioPin)
+{
+
+   char StrBuf[RPI_BTN_DEV_STR_MAX];
+   
+   snprintf(StrBuf, RPI_BTN_DEV_STR_MAX, INITBL_GetStrConfig(Button->IniTbl, CFG_BTN_DEV_STR_VALUE), GpioPin);
+   Button->QueryFileDescr = open(StrBuf, O_RDONLY);
+   if (Button->QueryFileDescr < 0)
+   {
+      CFE_EVS_SendEvent (BUTTON_OPEN_GPIO_EID, CFE_EVS_EventType_ERROR, 
+                         "Failed to open query file %s", StrBuf);
+   }
+
+} /* End OpenQueryFile() */
+
+
+/******************************************************************************
+**
+** Read from a GPIO pin
+**
+*/
+static bool ReadGpio(void)
+{
+
+   char ValueStr[3];
+   int  Status = read(Button->FileDescr, ValueStr, 3);
+ 
+   if (Status > 0)
+   {
+      lseek(Button->FileDescr, 0, SEEK_SET);
+      if (ValueStr[0] == '0')
+      {
+         Button->LastRead = 0;
+      }
+      else
+      {
+         Button->LastRead = 1;
+      }
+   }
+   
+   return true;
+   
+} /* ReadGpio() */
+
+
+/******************************************************************************
+**
+** Set which edge will trigger interrupt: rising, falling, both
+**
+*/
+static bool SetGpioEdge(int GpioPin, const char *Edge) 
+{
+
+   char StrBuf[RPI_BTN_DEV_STR_MAX];
+   int FileDescr;
+   bool RetStatus = false;
+   
+   snprintf(StrBuf, RPI_BTN_DEV_STR_MAX, INITBL_GetStrConfig(Button->IniTbl, CFG_BTN_DEV_STR_EDGE), GpioPin);
+   FileDescr = open(StrBuf, O_WRONLY);
+   if (FileDescr >= 0)
+   {
+      write(FileDescr, Edge, strlen(Edge)+1);
+      close(FileDescr);
+      RetStatus = true;
+   }
+   else
+   {
+      CFE_EVS_SendEvent (BUTTON_SET_EDGE_EID, CFE_EVS_EventType_ERROR, 
+                         "Failed to set edge %s to '%s'", StrBuf, Edge);         
+   }
+   
+   return RetStatus;
+
+} /* End SetGpioEdge() */
+
+
+#if !RPI_BTN_FIXED_PROFILE
+/******************************************************************************
+**
+** Convert an ini file edge string to an RPI_BTN_EDGE_* value
+**
+*/
+static uint8 EdgeStrToEdge(const char *Edge)
+{
+
+   uint8 i;
+   uint8 RetEdge = RPI_BTN_EDGE_BOTH;
+   bool  Found = false;
+   
+   for (i=0; i < (sizeof(EdgeStr)/sizeof(EdgeStr[0])) && !Found; i++)
+   {
+      if (strcmp(Edge, EdgeStr[i]) == 0)
+      {
+         RetEdge = i;
+         Found = true;
+      }
+   }
+   
+   if (!Found)
+   {
+      CFE_EVS_SendEvent (BUTTON_SET_EDGE_EID, CFE_EVS_EventType_ERROR, 
+                         "Invalid edge '%s', using '%s'", Edge, EdgeStr[RPI_BTN_EDGE_BOTH]);         
+   }
+   
+   return RetEdge;
+
+} /* End EdgeStrToEdge() */
+#endif
+
+
+/******************************************************************************
+**
+** Write to a GPIO output pin
+**
+** Notes:
+**   1. pwrite() at offset 0 replaces the write() and lseek() pair
+**
+*/
+static bool WriteGpio(int FileDescr, int Bit)
+{
+   
+   bool RetStatus = (pwrite(FileDescr, (Bit == 0) ? "0" : "1", 1, 0) == 1);
+   
+   if (RetStatus)
+   {
+      Button->LastWrite = (Bit == 0) ? 0 : 1;
+   }
+   
+   return RetStatus;
 
-} WriteGpio() */
\ No newline at end of file
+} /* End WriteGpio() */
@@ -27,13 +27,30 @@
 /*
 ** Includes
 */
-#include <poll.h>
+#include <stdatomic.h>
 #include "app_cfg.h"
+#include "evt_engine.h"
+#include "keypad.h"
+#include "encoder.h"
+#include "pulse.h"
+#include "pwm.h"
+#include "shm_export.h"
+#include "event_route.h"
+#include "capture.h"
 
 /***********************/
 /** Macro Definitions **/
 /***********************/
 
+#define BUTTON_RATE_BUCKETS   60   /* One second buckets, must cover the longest rate window */
+#define BUTTON_RATE_WIN_MID   10   /* Seconds in the intermediate rate window */
+
+#define BUTTON_MODE_BUTTON_STR  "button"
+#define BUTTON_MODE_KEYPAD_STR  "keypad"
+#define BUTTON_MODE_ENCODER_STR "encoder"
+#define BUTTON_MODE_PULSE_STR   "pulse"
+#define BUTTON_MODE_PWM_STR     "pwm"
+
 
 /*
 ** Event Message IDs
@@ -43,12 +60,185 @@
 #define BUTTON_OPEN_GPIO_EID    (BUTTON_BASE_EID + 1)
 #define BUTTON_SET_EDGE_EID     (BUTTON_BASE_EID + 2)
 #define BUTTON_CHILD_TASK_EID   (BUTTON_BASE_EID + 3)
+#define BUTTON_READ_LEVEL_EID   (BUTTON_BASE_EID + 4)
+#define BUTTON_CDS_EID          (BUTTON_BASE_EID + 5)
+#define BUTTON_SELF_TEST_EID    (BUTTON_BASE_EID + 6)
 
 
 /**********************/
 /** Type Definitions **/
 /**********************/
 
+typedef enum
+{
+
+   BUTTON_GPIO_IN  = 1,
+   BUTTON_GPIO_OUT = 2
+
+} BUTTON_GpioDir_t;
+
+typedef enum
+{
+
+   BUTTON_MODE_BUTTON  = 1,  /* Edge driven single button line */
+   BUTTON_MODE_KEYPAD  = 2,  /* Periodically scanned key matrix */
+   BUTTON_MODE_ENCODER = 3,  /* Quadrature encoder on a GPIO character device line pair */
+   BUTTON_MODE_PULSE   = 4,  /* Pulse counter on a GPIO character device line */
+   BUTTON_MODE_PWM     = 5   /* PWM measurement on a GPIO character device line */
+
+} BUTTON_Mode_t;
+
+
+/******************************************************************************
+** Critical Data Store
+**
+** - Data that is preserved across app restarts and processor resets
+** - Kept small because the entire block is copied to the CDS after every
+**   batch of edges
+*/
+
+typedef struct
+{
+   
+   CFE_TIME_SysTime_t Time;
+   uint32             Level;
+   
+} BUTTON_EdgeHist_t;
+
+typedef struct
+{
+
+   uint32  PressedCount;
+   uint32  EdgeHistIdx;    /* Index of the next entry to be written */
+   
+   BUTTON_EdgeHist_t  EdgeHist[RPI_BTN_CDS_EDGE_HIST_LEN];
+   
+} BUTTON_CdsData_t;
+
+
+/******************************************************************************
+** Button state consumed by the main task
+**
+** - Written by the child task and read using BUTTON_GetState()
+*/
+
+typedef struct
+{
+
+   bool    GpioConnected;
+   uint8   GpioPin;
+   uint32  PressedCount;
+   uint32  PressCnt;
+   int     LastRead;
+   int     LastWrite;
+   
+   CFE_TIME_SysTime_t LastEdgeTime;
+   
+   uint8   EventEngine;
+   uint32  ChildWakeCnt;
+   uint32  ChildSyscallCnt;
+   
+   uint32  EdgeSeq;
+   uint32  SourceLostCnt;
+   uint32  EngineLostCnt;
+   uint32  ExportLostCnt;
+   uint32  SbLostCnt;
+   uint32  MacroSentCnt;
+   
+} BUTTON_State_t;
+
+
+/******************************************************************************
+** Sliding window press rates
+**
+** - Owned by the main task and updated once per second
+** - Bucket[] holds the number of presses in each of the last 60 seconds
+** - Running sums make each update O(1) regardless of the window sizes
+*/
+
+typedef struct
+{
+
+   uint32  LastPressCnt;
+   uint32  BucketIdx;        /* Index of the most recent bucket */
+   uint32  BucketsFilled;    /* Saturates at BUTTON_RATE_BUCKETS, used during startup */
+   uint32  Bucket[BUTTON_RATE_BUCKETS];
+   
+   uint32  Sum10s;
+   uint32  Sum60s;
+   
+   float   Rate1s;
+   float   Rate10s;
+   float   Rate60s;
+   
+} BUTTON_PressRate_t;
+
+
+/******************************************************************************
+** Loopback self-test
+**
+** - The main task validates a start command, sets Running and wakes the
+**   child task. The child task toggles the output, measures the write to
+**   detection latency of each toggle, sends SelfTestTlm and clears Running.
+** - Times are CLOCK_MONOTONIC nanoseconds
+*/
+
+typedef struct
+{
+
+   atomic_bool  Running;
+   uint16       Toggles;
+   uint16       RateHz;
+   
+   int     OutFileDescr;    /* Output pin or simulated input value file, 0 until opened */
+   
+   /* Owned by the child task */
+   bool    Active;
+   bool    AwaitingEdge;
+   int     OutLevel;
+   uint16  ToggleCnt;
+   uint16  DetectedCnt;
+   uint16  MissedCnt;
+   uint64  PeriodNs;
+   uint64  NextToggleNs;
+   uint64  WriteNs;
+   uint32  LatencyUs[RPI_BTN_SELF_TEST_MAX_SAMPLES];
+   
+   RPI_BTN_SelfTestTlm_t  Tlm;
+   
+} BUTTON_SelfTest_t;
+
+
+/******************************************************************************
+** Child task diagnostics
+**
+** - The main task sets SampleRequested and wakes the child task on each 1Hz
+**   tick. getrusage(RUSAGE_THREAD) only reports the calling thread so the
+**   child task takes the sample and sends ChildDiagTlm.
+** - Last* values are the previous sample, the first sample only primes them
+*/
+
+typedef struct
+{
+
+   bool         Enabled;
+   atomic_bool  SampleRequested;
+   
+   /* Owned by the child task */
+   bool    Primed;
+   uint64  LastNs;
+   uint64  LastUserCpuUs;
+   uint64  LastSysCpuUs;
+   uint64  LastVolCtxSw;
+   uint64  LastInvolCtxSw;
+   uint32  LastWakeCnt;
+   uint32  LastEdgeCnt;
+   uint32  LastSyscallCnt;
+   
+   RPI_BTN_ChildDiagTlm_t  Tlm;
+   
+} BUTTON_ChildDiag_t;
+
 
 /******************************************************************************
 ** BUTTON_Class
@@ -67,16 +257,61 @@ typedef struct
    /*
    ** Class State Data
    */
-   struct pollfd PollFileDescr[1];
    
+   EVT_ENGINE_Class_t EvtEngine;
+   KEYPAD_Class_t     Keypad;
+   ENCODER_Class_t    Encoder;
+   PULSE_Class_t      Pulse;
+   PWM_Class_t        Pwm;
+   SHM_EXPORT_Class_t ShmExport;
+   EVENT_MACRO_Class_t EventMacro;
+   EVENT_ROUTE_Class_t EventRoute;
+   CAPTURE_Class_t    Capture;
+   
+   BUTTON_Mode_t Mode;
    bool  GpioConnected;
    uint8 GpioPin;
+   uint8 Edge;             /* RPI_BTN_EDGE_* */
+   uint8 ActiveLevel;      /* Pressed level */
    
    int   FileDescr;
-   int   PressedCount;
+   int   QueryFileDescr;   /* Separate open file so main task reads don't consume child task poll events */
    int   LastRead;
    int   LastWrite;
    
+   CFE_TIME_SysTime_t LastEdgeTime;
+   
+   uint32  PressCnt;         /* Press edges since the app started, see ButtonPressed() */
+   
+   /*
+   ** Edge sequence. Every edge is numbered and edges known to be lost
+   ** consume sequence numbers so downstream consumers see the gaps.
+   */
+   
+   uint32  EdgeSeq;          /* Sequence number of the last edge */
+   uint32  SourceLostCnt;    /* Edges coalesced by sysfs before they were read */
+   uint32  EngineLostCnt;    /* Event engine losses already counted in EdgeSeq */
+   
+   bool                CdsEnabled;
+   CFE_ES_CDSHandle_t  CdsHandle;
+   BUTTON_CdsData_t    CdsData;
+   
+   /*
+   ** Published state. StateSeq is a sequence lock that is odd while the
+   ** child task is updating State.
+   */
+   
+   atomic_uint     StateSeq;
+   BUTTON_State_t  State;
+   
+   BUTTON_PressRate_t  PressRate;
+   
+   BUTTON_SelfTest_t   SelfTest;
+   
+   BUTTON_ChildDiag_t  ChildDiag;
+   
+   atomic_bool  ResetRequested;   /* Set by BUTTON_ResetStatus(), cleared by the child task */
+   
 } BUTTON_Class_t;
 
 
@@ -93,6 +328,8 @@ typedef struct
 **
 ** Notes:
 **   1. This must be called prior to any other function.
+**   2. The pressed count and edge history are restored from the Critical
+**      Data Store when the app is restarted.
 **
 */
 void BUTTON_Constructor(BUTTON_Class_t *ButtonPtr, INITBL_Class_t *IniTbl);
@@ -105,6 +342,94 @@ void BUTTON_Constructor(BUTTON_Class_t *ButtonPtr, INITBL_Class_t *IniTbl);
 bool BUTTON_ChildTask(CHILDMGR_Class_t *ChildMgr);
 
 
+/******************************************************************************
+** Function: BUTTON_GetState
+**
+** Copy a consistent snapshot of the button state.
+**
+** Notes:
+**   1. Lock-free, the caller retries if the child task published a new
+**      state during the copy. The child task never waits on a reader.
+**
+*/
+void BUTTON_GetState(BUTTON_State_t *State);
+
+
+/******************************************************************************
+** Function: BUTTON_OpenGpio
+**
+** Export a GPIO pin, set its direction and open its value file.
+**
+** Notes:
+**   1. FileDescr returns the value file descriptor. If it's non-zero on
+**      entry the existing file is closed and the pin is unexported first.
+**   2. Used by the Button line, the self-test output and the keypad rows
+**      and columns.
+**
+*/
+bool BUTTON_OpenGpio(int GpioPin, BUTTON_GpioDir_t Direction, int *FileDescr);
+
+
+/******************************************************************************
+** Function: BUTTON_ReadLevel
+**
+** Read the current level of the button line.
+**
+** Notes:
+**   1. Called from the main app task. The read uses a file descriptor that is
+**      independent from the child task's poll file descriptor so a query
+**      never consumes or masks an edge the child task is waiting on.
+**
+*/
+bool BUTTON_ReadLevel(int *Level);
+
+
+/******************************************************************************
+** Function: BUTTON_RequestChildDiag
+**
+** Request a child task resource usage sample.
+**
+** Notes:
+**   1. Called from the main app task on each 1Hz tick. The child task is
+**      woken to take the sample and send ChildDiagTlm so each sample costs
+**      the child task one wake.
+**   2. Does nothing if CHILD_DIAG_ENABLE is 0 or the mode's inputs aren't
+**      connected.
+**
+*/
+void BUTTON_RequestChildDiag(void);
+
+
+/******************************************************************************
+** Function: BUTTON_StartSelfTestCmd
+**
+** Start a loopback latency self-test.
+**
+** Notes:
+**   1. The test runs in the child task, the results are reported in
+**      SelfTestTlm when the test completes.
+**   2. Edges detected during a test take the normal edge path but they are
+**      not counted as button presses.
+**
+*/
+bool BUTTON_StartSelfTestCmd(void* DataObjPtr, const CFE_MSG_Message_t *MsgPtr);
+
+
+/******************************************************************************
+** Function: BUTTON_UpdatePressRates
+**
+** Update the sliding window press rates.
+**
+** Notes:
+**   1. Must be called once per second from the main task. Presses are only
+**      counted by the child task, the rates are derived from the change in
+**      the published press count. A press is counted once even when both
+**      of its edges are detected.
+**
+*/
+void BUTTON_UpdatePressRates(void);
+
+
 /******************************************************************************
 ** Function: BUTTON_ResetStatus
 **
@@ -113,6 +438,8 @@ bool BUTTON_ChildTask(CHILDMGR_Class_t *ChildMgr);
 ** Notes:
 **   1. Any counter or variable that is reported in HK telemetry that doesn't
 **      change the functional behavior should be reset.
+**   2. Called by the main task. The child task owns the counters and resets
+**      them the next time it wakes so the reset is reported asynchronously.
 **
 */
 void BUTTON_ResetStatus(void);
@@ -0,0 +1,413 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the pre-trigger edge capture Class methods
+**
+**  Notes:
+**    1. See capture.h prologue for the triggers and the post-trigger window.
+**    2. EdgeCnt indexes the circular buffer modulo RPI_BTN_CAPTURE_EDGES
+**       which is a power of 2 so the index stays continuous when EdgeCnt
+**       wraps.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+
+#include "capture.h"
+
+
+/**********************/
+/** Global File Data **/
+/**********************/
+
+/* Indexed by RPI_BTN_CaptureTrigger_t */
+static const char* TriggerStr[] = { "", "short pulse", "burst" };
+
+
+/*******************************/
+/** Local Function Prototypes **/
+/*******************************/
+
+static void SendDump(CAPTURE_Class_t *Capture);
+
+
+/******************************************************************************
+** Function: CAPTURE_Constructor
+**
+*/
+void CAPTURE_Constructor(CAPTURE_Class_t *Capture, INITBL_Class_t *IniTbl,
+                         EVT_ENGINE_Class_t *EvtEngine, bool Enabled)
+{
+
+   memset(Capture, 0, sizeof(CAPTURE_Class_t));
+
+   Capture->EvtEngine = EvtEngine;
+   Capture->Enabled   = Enabled;
+   atomic_init(&Capture->Request, CAPTURE_REQ_NONE);
+   atomic_init(&Capture->Armed, false);
+
+   CFE_MSG_Init(CFE_MSG_PTR(Capture->Tlm.TelemetryHeader),
+                CFE_SB_ValueToMsgId(INITBL_GetIntConfig(IniTbl, CFG_RPI_BTN_CAPTURE_TLM_TOPICID)),
+                sizeof(RPI_BTN_CaptureTlm_t));
+
+} /* End CAPTURE_Constructor() */
+
+
+/******************************************************************************
+** Function: CAPTURE_ArmCmd
+**
+** Notes:
+**   1. A request the child task hasn't taken yet rejects the command so
+**      Pending is never written while the child task may be reading it.
+**
+*/
+bool CAPTURE_ArmCmd(void* DataObjPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+
+   CAPTURE_Class_t *Capture = (CAPTURE_Class_t *)DataObjPtr;
+   const RPI_BTN_ArmCapture_CmdPayload_t *Cmd = CMDMGR_PAYLOAD_PTR(MsgPtr, RPI_BTN_ArmCapture_t);
+   CAPTURE_Config_t *Pending = &Capture->Pending;
+   bool RetStatus = false;
+
+   if (!Capture->Enabled)
+   {
+      CFE_EVS_SendEvent(CAPTURE_ARM_EID, CFE_EVS_EventType_ERROR,
+                        "Arm capture rejected, the button line is not connected");
+   }
+   else if (atomic_load(&Capture->Request) != CAPTURE_REQ_NONE)
+   {
+      CFE_EVS_SendEvent(CAPTURE_ARM_EID, CFE_EVS_EventType_ERROR,
+                        "Arm capture rejected, the previous capture command is still pending");
+   }
+   else if (Cmd->Trigger == RPI_BTN_CaptureTrigger_SHORT_PULSE && Cmd->PulseUs == 0)
+   {
+      CFE_EVS_SendEvent(CAPTURE_ARM_EID, CFE_EVS_EventType_ERROR,
+                        "Arm capture rejected, the short pulse threshold must be greater than 0");
+   }
+   else if (Cmd->Trigger == RPI_BTN_CaptureTrigger_BURST &&
+            (Cmd->BurstEdges < 1 || Cmd->BurstEdges >= RPI_BTN_CAPTURE_EDGES || Cmd->BurstMs == 0))
+   {
+      CFE_EVS_SendEvent(CAPTURE_ARM_EID, CFE_EVS_EventType_ERROR,
+                        "Arm capture rejected, invalid burst of %d edges in %dms. Valid edges [1..%d] and time greater than 0",
+                        Cmd->BurstEdges, Cmd->BurstMs, RPI_BTN_CAPTURE_EDGES - 1);
+   }
+   else if (Cmd->Trigger != RPI_BTN_CaptureTrigger_SHORT_PULSE && Cmd->Trigger != RPI_BTN_CaptureTrigger_BURST)
+   {
+      CFE_EVS_SendEvent(CAPTURE_ARM_EID, CFE_EVS_EventType_ERROR,
+                        "Arm capture rejected, invalid trigger %d", Cmd->Trigger);
+   }
+   else if (Cmd->PostEdges >= RPI_BTN_CAPTURE_EDGES)
+   {
+      CFE_EVS_SendEvent(CAPTURE_ARM_EID, CFE_EVS_EventType_ERROR,
+                        "Arm capture rejected, invalid post-trigger edges %d. Valid range [0..%d]",
+                        Cmd->PostEdges, RPI_BTN_CAPTURE_EDGES - 1);
+   }
+   else
+   {
+
+      Pending->Trigger    = Cmd->Trigger;
+      Pending->PulseNs    = (uint64)Cmd->PulseUs * 1000;
+      Pending->BurstEdges = Cmd->BurstEdges;
+      Pending->BurstNs    = (uint64)Cmd->BurstMs * 1000000;
+      Pending->PostEdges  = Cmd->PostEdges;
+      Pending->PostNs     = (uint64)Cmd->PostMs * 1000000;
+
+      atomic_store(&Capture->Request, CAPTURE_REQ_ARM);
+      EVT_ENGINE_Wake(Capture->EvtEngine);
+
+      if (Cmd->PostMs == 0)
+      {
+         CFE_EVS_SendEvent(CAPTURE_ARM_EID, CFE_EVS_EventType_INFORMATION,
+                           "Capture armed with a %s trigger and %d post-trigger edges",
+                           TriggerStr[Cmd->Trigger], Cmd->PostEdges);
+      }
+      else
+      {
+         CFE_EVS_SendEvent(CAPTURE_ARM_EID, CFE_EVS_EventType_INFORMATION,
+                           "Capture armed with a %s trigger and %d post-trigger edges within %dms",
+                           TriggerStr[Cmd->Trigger], Cmd->PostEdges, Cmd->PostMs);
+      }
+      RetStatus = true;
+
+   }
+
+   return RetStatus;
+
+} /* End CAPTURE_ArmCmd() */
+
+
+/******************************************************************************
+** Function: CAPTURE_DisarmCmd
+**
+** Notes:
+**   1. A disarm replaces an arm request the child task hasn't taken yet.
+**   2. Armed is published by the child task after each service so a capture
+**      that froze since then is still disarmed and its dump discarded.
+**
+*/
+bool CAPTURE_DisarmCmd(void* DataObjPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+
+   CAPTURE_Class_t *Capture = (CAPTURE_Class_t *)DataObjPtr;
+   bool RetStatus = false;
+
+   if (!Capture->Enabled)
+   {
+      CFE_EVS_SendEvent(CAPTURE_DISARM_EID, CFE_EVS_EventType_ERROR,
+                        "Disarm capture rejected, the button line is not connected");
+   }
+   else if (atomic_load(&Capture->Request) != CAPTURE_REQ_ARM && !atomic_load(&Capture->Armed))
+   {
+      CFE_EVS_SendEvent(CAPTURE_DISARM_EID, CFE_EVS_EventType_ERROR,
+                        "Disarm capture rejected, no capture is armed");
+   }
+   else
+   {
+
+      atomic_store(&Capture->Request, CAPTURE_REQ_DISARM);
+      EVT_ENGINE_Wake(Capture->EvtEngine);
+
+      CFE_EVS_SendEvent(CAPTURE_DISARM_EID, CFE_EVS_EventType_INFORMATION, "Capture disarmed");
+      RetStatus = true;
+
+   }
+
+   return RetStatus;
+
+} /* End CAPTURE_DisarmCmd() */
+
+
+/******************************************************************************
+** Function: CAPTURE_Edge
+**
+** Notes:
+**   1. BurstEdges is less than RPI_BTN_CAPTURE_EDGES so the edge BurstEdges
+**      before this one is still in the buffer.
+**
+*/
+void CAPTURE_Edge(CAPTURE_Class_t *Capture, uint32 EdgeSeq, uint8 Level, uint64 DetectNs)
+{
+
+   CAPTURE_Config_t *Config = &Capture->Config;
+   const RPI_BTN_CaptureEdge_t *RefEdge;
+   RPI_BTN_CaptureEdge_t *Edge;
+   bool Triggered = false;
+
+   if (Capture->State != CAPTURE_ARMED && Capture->State != CAPTURE_TRIGGERED)
+   {
+      return;
+   }
+
+   if (Capture->State == CAPTURE_ARMED)
+   {
+      if (Config->Trigger == RPI_BTN_CaptureTrigger_SHORT_PULSE)
+      {
+         if (Capture->EdgeCnt > 0)
+         {
+            RefEdge   = &Capture->Edge[(Capture->EdgeCnt - 1) % RPI_BTN_CAPTURE_EDGES];
+            Triggered = (EdgeSeq != RefEdge->EdgeSeq + 1) || ((DetectNs - RefEdge->TimeNs) < Config->PulseNs);
+         }
+      }
+      else if (Capture->EdgeCnt >= Config->BurstEdges)
+      {
+         RefEdge   = &Capture->Edge[(Capture->EdgeCnt - Config->BurstEdges) % RPI_BTN_CAPTURE_EDGES];
+         Triggered = ((DetectNs - RefEdge->TimeNs) <= Config->BurstNs);
+      }
+   }
+
+   Edge = &Capture->Edge[Capture->EdgeCnt % RPI_BTN_CAPTURE_EDGES];
+   Edge->TimeNs  = DetectNs;
+   Edge->EdgeSeq = EdgeSeq;
+   Edge->Level   = Level;
+   Capture->EdgeCnt++;
+
+   if (Triggered)
+   {
+
+      Capture->State         = CAPTURE_TRIGGERED;
+      Capture->TriggerSeq    = EdgeSeq;
+      Capture->TriggerNs     = DetectNs;
+      Capture->PostRemaining = Config->PostEdges;
+      Capture->PostEndNs     = DetectNs + Config->PostNs;
+
+      CFE_EVS_SendEvent(CAPTURE_TRIGGER_EID, CFE_EVS_EventType_INFORMATION,
+                        "Capture triggered by a %s at edge %u", TriggerStr[Config->Trigger], EdgeSeq);
+
+      if (Capture->PostRemaining == 0)
+      {
+         Capture->State = CAPTURE_FROZEN;
+      }
+
+   }
+   else if (Capture->State == CAPTURE_TRIGGERED)
+   {
+      if (--Capture->PostRemaining == 0)
+      {
+         Capture->State = CAPTURE_FROZEN;
+      }
+   }
+
+} /* End CAPTURE_Edge() */
+
+
+/******************************************************************************
+** Function: CAPTURE_Service
+**
+** Notes:
+**   1. The request is cleared with a compare and exchange after Pending has
+**      been copied. If a disarm replaced the request in the meantime the
+**      loop applies it too.
+**
+*/
+void CAPTURE_Service(CAPTURE_Class_t *Capture, uint64 NowNs)
+{
+
+   int Request = atomic_load_explicit(&Capture->Request, memory_order_acquire);
+
+   while (Request != CAPTURE_REQ_NONE)
+   {
+
+      if (Request == CAPTURE_REQ_ARM)
+      {
+         Capture->Config  = Capture->Pending;
+         Capture->State   = CAPTURE_ARMED;
+         Capture->EdgeCnt = 0;
+      }
+      else
+      {
+         Capture->State = CAPTURE_IDLE;
+      }
+
+      if (atomic_compare_exchange_strong(&Capture->Request, &Request, CAPTURE_REQ_NONE))
+      {
+         break;
+      }
+
+   } /* End while request */
+
+   if (Capture->State == CAPTURE_TRIGGERED && Capture->Config.PostNs > 0 && NowNs >= Capture->PostEndNs)
+   {
+      Capture->State = CAPTURE_FROZEN;
+   }
+
+   if (Capture->State == CAPTURE_FROZEN)
+   {
+      SendDump(Capture);
+      Capture->State = CAPTURE_IDLE;
+   }
+
+   atomic_store(&Capture->Armed, (Capture->State != CAPTURE_IDLE));
+
+} /* End CAPTURE_Service() */
+
+
+/******************************************************************************
+** Function: CAPTURE_TimeoutMs
+**
+*/
+int CAPTURE_TimeoutMs(const CAPTURE_Class_t *Capture, uint64 NowNs)
+{
+
+   int TimeoutMs = -1;
+
+   if (Capture->State == CAPTURE_TRIGGERED && Capture->Config.PostNs > 0)
+   {
+      TimeoutMs = 0;
+      if (Capture->PostEndNs > NowNs)
+      {
+         TimeoutMs = (int)((Capture->PostEndNs - NowNs + 999999) / 1000000);
+      }
+   }
+
+   return TimeoutMs;
+
+} /* End CAPTURE_TimeoutMs() */
+
+
+/******************************************************************************
+** Function: SendDump
+**
+** Send the captured edges oldest first in CaptureTlm segments.
+**
+** Notes:
+**   1. Only the last RPI_BTN_CAPTURE_EDGES edges are sent if more were
+**      recorded while armed. Unused entries in the last segment are zero.
+**
+*/
+static void SendDump(CAPTURE_Class_t *Capture)
+{
+
+   RPI_BTN_CaptureTlm_Payload_t *Payload = &Capture->Tlm.Payload;
+   uint32 EdgeCnt;
+   uint32 FirstEdge;
+   uint32 SegmentEdges;
+   uint32 i;
+   uint16 SendErrCnt = 0;
+
+   EdgeCnt   = (Capture->EdgeCnt < RPI_BTN_CAPTURE_EDGES) ? Capture->EdgeCnt : RPI_BTN_CAPTURE_EDGES;
+   FirstEdge = Capture->EdgeCnt - EdgeCnt;
+
+   Capture->CaptureId++;
+
+   Payload->TriggerNs  = Capture->TriggerNs;
+   Payload->TriggerSeq = Capture->TriggerSeq;
+   Payload->CaptureId  = Capture->CaptureId;
+   Payload->EdgeCnt    = EdgeCnt;
+   Payload->SegmentCnt = (EdgeCnt + CAPTURE_SEGMENT_EDGES - 1) / CAPTURE_SEGMENT_EDGES;
+   Payload->Trigger    = Capture->Config.Trigger;
+
+   for (Payload->Segment = 0; Payload->Segment < Payload->SegmentCnt; Payload->Segment++)
+   {
+
+      SegmentEdges = EdgeCnt - Payload->Segment * CAPTURE_SEGMENT_EDGES;
+      if (SegmentEdges > CAPTURE_SEGMENT_EDGES)
+      {
+         SegmentEdges = CAPTURE_SEGMENT_EDGES;
+      }
+
+      memset(Payload->Edge, 0, sizeof(Payload->Edge));
+      for (i=0; i < SegmentEdges; i++)
+      {
+         Payload->Edge[i] = Capture->Edge[(FirstEdge + i) % RPI_BTN_CAPTURE_EDGES];
+      }
+      Payload->SegmentEdges = SegmentEdges;
+      FirstEdge += SegmentEdges;
+
+      CFE_SB_TimeStampMsg(CFE_MSG_PTR(Capture->Tlm.TelemetryHeader));
+      if (CFE_SB_TransmitMsg(CFE_MSG_PTR(Capture->Tlm.TelemetryHeader), true) != CFE_SUCCESS)
+      {
+         SendErrCnt++;
+      }
+
+   } /* End segment loop */
+
+   if (SendErrCnt == 0)
+   {
+      CFE_EVS_SendEvent(CAPTURE_DUMP_EID, CFE_EVS_EventType_INFORMATION,
+                        "Capture %d sent, %d edges in %d segments",
+                        Payload->CaptureId, EdgeCnt, Payload->SegmentCnt);
+   }
+   else
+   {
+      CFE_EVS_SendEvent(CAPTURE_DUMP_EID, CFE_EVS_EventType_ERROR,
+                        "Capture %d incomplete, %d of %d segments failed to send",
+                        Payload->CaptureId, SendErrCnt, Payload->SegmentCnt);
+   }
+
+} /* End SendDump() */
@@ -0,0 +1,243 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the pre-trigger edge capture class
+**
+**  Notes:
+**    1. Works like a logic analyzer for intermittent button faults. While
+**       armed every button edge is recorded in a circular buffer of the
+**       last RPI_BTN_CAPTURE_EDGES edges. When the trigger condition is
+**       met the capture continues for a post-trigger window and then the
+**       buffer is frozen and sent as a segmented CaptureTlm dump. A capture
+**       is single-shot, it must be armed again for the next one.
+**    2. Triggers:
+**       - SHORT_PULSE: An edge detected less than PulseUs after the previous
+**                      edge or a gap in the edge sequence numbers. A gap
+**                      means edges were lost which only happens when they
+**                      are closer together than the child task can read.
+**       - BURST:       More than BurstEdges edges within BurstMs
+**    3. The post-trigger window ends after PostEdges edges or PostMs,
+**       whichever is first. PostEdges 0 freezes the buffer at the trigger
+**       edge and PostMs 0 waits for PostEdges edges.
+**    4. The commands run in the main task. They validate the parameters and
+**       pass a request to the child task which owns the buffer, the same
+**       handoff as the self-test. The buffer is allocated with the object
+**       so a capture doesn't allocate memory.
+**
+*/
+
+#ifndef _capture_
+#define _capture_
+
+/*
+** Includes
+*/
+
+#include <stdatomic.h>
+#include "app_cfg.h"
+#include "evt_engine.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#if (RPI_BTN_CAPTURE_EDGES & (RPI_BTN_CAPTURE_EDGES - 1)) != 0
+   #error RPI_BTN_CAPTURE_EDGES must be a power of 2
+#endif
+
+#define CAPTURE_SEGMENT_EDGES  (sizeof(((RPI_BTN_CaptureTlm_Payload_t *)0)->Edge) / sizeof(RPI_BTN_CaptureEdge_t))
+
+
+/*
+** Event Message IDs
+*/
+
+#define CAPTURE_ARM_EID      (CAPTURE_BASE_EID + 0)
+#define CAPTURE_DISARM_EID   (CAPTURE_BASE_EID + 1)
+#define CAPTURE_TRIGGER_EID  (CAPTURE_BASE_EID + 2)
+#define CAPTURE_DUMP_EID     (CAPTURE_BASE_EID + 3)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+typedef enum
+{
+
+   CAPTURE_REQ_NONE   = 0,
+   CAPTURE_REQ_ARM    = 1,
+   CAPTURE_REQ_DISARM = 2
+
+} CAPTURE_Request_t;
+
+typedef enum
+{
+
+   CAPTURE_IDLE      = 0,
+   CAPTURE_ARMED     = 1,
+   CAPTURE_TRIGGERED = 2,   /* Recording the post-trigger window */
+   CAPTURE_FROZEN    = 3    /* Waiting to be dumped */
+
+} CAPTURE_State_t;
+
+
+/******************************************************************************
+** Capture configuration set by the arm command
+*/
+
+typedef struct
+{
+
+   RPI_BTN_CaptureTrigger_t Trigger;
+   uint64  PulseNs;
+   uint16  BurstEdges;
+   uint64  BurstNs;
+   uint16  PostEdges;
+   uint64  PostNs;
+
+} CAPTURE_Config_t;
+
+
+/******************************************************************************
+** CAPTURE_Class
+*/
+
+typedef struct
+{
+
+   /*
+   ** Framework References
+   */
+
+   EVT_ENGINE_Class_t *EvtEngine;
+
+
+   /*
+   ** Class State Data
+   */
+
+   bool  Enabled;                  /* Button line connected */
+
+   /*
+   ** Main task to child task handoff. Pending is written by the main task
+   ** before it stores an arm Request and only read by the child task after
+   ** it takes the request.
+   */
+
+   atomic_int        Request;
+   CAPTURE_Config_t  Pending;
+   atomic_bool       Armed;        /* Published by the child task, State is armed or triggered */
+
+   /* Owned by the child task */
+   CAPTURE_State_t   State;
+   CAPTURE_Config_t  Config;
+   uint32  EdgeCnt;                /* Edges recorded since armed */
+   uint16  PostRemaining;
+   uint64  PostEndNs;
+   uint32  TriggerSeq;
+   uint64  TriggerNs;
+   uint16  CaptureId;
+
+   RPI_BTN_CaptureEdge_t  Edge[RPI_BTN_CAPTURE_EDGES];
+
+   RPI_BTN_CaptureTlm_t  Tlm;
+
+} CAPTURE_Class_t;
+
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: CAPTURE_Constructor
+**
+** Initialize the capture object to a known state.
+**
+** Notes:
+**   1. Enabled is false when the button line isn't connected, the arm
+**      command is rejected.
+**
+*/
+void CAPTURE_Constructor(CAPTURE_Class_t *Capture, INITBL_Class_t *IniTbl,
+                         EVT_ENGINE_Class_t *EvtEngine, bool Enabled);
+
+
+/******************************************************************************
+** Function: CAPTURE_ArmCmd
+**
+** Arm a single-shot capture, replacing a capture that is already armed.
+**
+*/
+bool CAPTURE_ArmCmd(void* DataObjPtr, const CFE_MSG_Message_t *MsgPtr);
+
+
+/******************************************************************************
+** Function: CAPTURE_DisarmCmd
+**
+** Disarm the capture. A capture that has triggered but hasn't been sent is
+** discarded.
+**
+** Notes:
+**   1. Rejected if the button line isn't connected or no capture is armed
+**      or waiting to be armed by the child task.
+**
+*/
+bool CAPTURE_DisarmCmd(void* DataObjPtr, const CFE_MSG_Message_t *MsgPtr);
+
+
+/******************************************************************************
+** Function: CAPTURE_Edge
+**
+** Record a button edge and check the trigger condition.
+**
+** Notes:
+**   1. Called by the child task for each edge. Does nothing unless a
+**      capture is armed or triggered.
+**   2. DetectNs is the CLOCK_MONOTONIC time the edge was detected.
+**
+*/
+void CAPTURE_Edge(CAPTURE_Class_t *Capture, uint32 EdgeSeq, uint8 Level, uint64 DetectNs);
+
+
+/******************************************************************************
+** Function: CAPTURE_Service
+**
+** Apply arm and disarm requests, end the post-trigger window when PostMs
+** expires and send a frozen capture.
+**
+** Notes:
+**   1. Called by the child task after every wait. NowNs is the current
+**      CLOCK_MONOTONIC time.
+**
+*/
+void CAPTURE_Service(CAPTURE_Class_t *Capture, uint64 NowNs);
+
+
+/******************************************************************************
+** Function: CAPTURE_TimeoutMs
+**
+** Return the longest time in milliseconds the child task can wait before
+** CAPTURE_Service() must be called, -1 if there's no limit.
+**
+*/
+int CAPTURE_TimeoutMs(const CAPTURE_Class_t *Capture, uint64 NowNs);
+
+
+#endif /* _capture_ */
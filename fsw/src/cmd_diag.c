@@ -0,0 +1,237 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the main task command path diagnostics Class methods
+**
+**  Notes:
+**    1. See cmd_diag.h prologue for how the statistics are measured.
+**    2. All of the methods are called by the main task.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+
+#include "cmd_diag.h"
+#include "gpio_cdev.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define NS_PER_SEC  1000000000ULL
+
+
+/*******************************/
+/** Local Function Prototypes **/
+/*******************************/
+
+static void SendTlm(CMD_DIAG_Class_t *CmdDiag, uint64 IntervalNs);
+
+
+/******************************************************************************
+** Function: CMD_DIAG_Constructor
+**
+*/
+void CMD_DIAG_Constructor(CMD_DIAG_Class_t *CmdDiag, INITBL_Class_t *IniTbl,
+                          CFE_SB_MsgId_t CmdMid, CFE_SB_MsgId_t OneHzMid,
+                          CFE_SB_MsgId_t StatusTlmTickMid)
+{
+
+   RPI_BTN_CmdDiagTlm_Payload_t *Payload = &CmdDiag->Tlm.Payload;
+
+   memset(CmdDiag, 0, sizeof(CMD_DIAG_Class_t));
+
+   CmdDiag->Enabled = (INITBL_GetIntConfig(IniTbl, CFG_CMD_DIAG_ENABLE) != 0);
+
+   CFE_MSG_Init(CFE_MSG_PTR(CmdDiag->Tlm.TelemetryHeader),
+                CFE_SB_ValueToMsgId(INITBL_GetIntConfig(IniTbl, CFG_RPI_BTN_CMD_DIAG_TLM_TOPICID)),
+                sizeof(RPI_BTN_CmdDiagTlm_t));
+
+   Payload->PipeDepth = INITBL_GetIntConfig(IniTbl, CFG_CMD_PIPE_DEPTH);
+
+   Payload->Mid[CMD_DIAG_MID_CMD].MsgId    = CFE_SB_MsgIdToValue(CmdMid);
+   Payload->Mid[CMD_DIAG_MID_ONE_HZ].MsgId = CFE_SB_MsgIdToValue(OneHzMid);
+   if (!CFE_SB_MsgId_Equal(StatusTlmTickMid, OneHzMid))
+   {
+      Payload->Mid[CMD_DIAG_MID_STATUS_TICK].MsgId = CFE_SB_MsgIdToValue(StatusTlmTickMid);
+   }
+
+} /* End CMD_DIAG_Constructor() */
+
+
+/******************************************************************************
+** Function: CMD_DIAG_Received
+**
+** Notes:
+**   1. A message from the blocking receive starts a run. The pipe was empty
+**      when the receive started so the run length bounds the depth.
+**
+*/
+void CMD_DIAG_Received(CMD_DIAG_Class_t *CmdDiag, bool Queued)
+{
+
+   if (CmdDiag->Enabled)
+   {
+
+      CmdDiag->ReceiveNs = GPIO_CDEV_NowNs();
+      CmdDiag->Queued    = Queued;
+
+      if (Queued)
+      {
+         CmdDiag->RunLen++;
+      }
+      else
+      {
+         CmdDiag->RunStartNs = CmdDiag->ReceiveNs;
+         CmdDiag->RunLen     = 1;
+      }
+
+      if (CmdDiag->RunLen > CmdDiag->RunHwm)
+      {
+         CmdDiag->RunHwm = CmdDiag->RunLen;
+      }
+
+   } /* End if enabled */
+
+} /* End CMD_DIAG_Received() */
+
+
+/******************************************************************************
+** Function: CMD_DIAG_Processed
+**
+** Notes:
+**   1. Gaps are rounded to whole seconds so a late or early tick isn't
+**      counted as missed.
+**
+*/
+void CMD_DIAG_Processed(CMD_DIAG_Class_t *CmdDiag, CMD_DIAG_MidIdx_t MidIdx)
+{
+
+   CMD_DIAG_Mid_t *Mid = &CmdDiag->Mid[MidIdx];
+   uint64 DispatchNs;
+   uint64 WaitNs;
+   uint64 GapNs;
+   uint64 GapSec;
+
+   if (CmdDiag->Enabled)
+   {
+
+      DispatchNs = GPIO_CDEV_NowNs() - CmdDiag->ReceiveNs;
+
+      Mid->MsgCnt++;
+      Mid->DispatchSumNs += DispatchNs;
+      if (DispatchNs > Mid->MaxDispatchNs)
+      {
+         Mid->MaxDispatchNs = DispatchNs;
+      }
+
+      if (CmdDiag->Queued)
+      {
+         Mid->QueuedCnt++;
+         WaitNs = CmdDiag->ReceiveNs - CmdDiag->RunStartNs;
+         if (WaitNs > Mid->MaxWaitNs)
+         {
+            Mid->MaxWaitNs = WaitNs;
+         }
+      }
+
+      if (MidIdx == CMD_DIAG_MID_ONE_HZ)
+      {
+
+         if (CmdDiag->Primed)
+         {
+
+            GapNs  = CmdDiag->ReceiveNs - CmdDiag->LastTickNs;
+            GapSec = (GapNs + NS_PER_SEC/2) / NS_PER_SEC;
+            if (GapSec > 1)
+            {
+               CmdDiag->TicksMissed += GapSec - 1;
+            }
+
+            SendTlm(CmdDiag, GapNs);
+
+         }
+         else
+         {
+            memset(CmdDiag->Mid, 0, sizeof(CmdDiag->Mid));
+            CmdDiag->Primed = true;
+         }
+
+         CmdDiag->LastTickNs = CmdDiag->ReceiveNs;
+
+      } /* End if 1Hz tick */
+
+   } /* End if enabled */
+
+} /* End CMD_DIAG_Processed() */
+
+
+/******************************************************************************
+** Function: CMD_DIAG_ResetStatus
+**
+*/
+void CMD_DIAG_ResetStatus(CMD_DIAG_Class_t *CmdDiag)
+{
+
+   CmdDiag->RunHwm      = 0;
+   CmdDiag->TicksMissed = 0;
+
+} /* End CMD_DIAG_ResetStatus() */
+
+
+/******************************************************************************
+** Function: SendTlm
+**
+** Send the statistics of the interval that ended with the current tick and
+** start the next interval.
+**
+*/
+static void SendTlm(CMD_DIAG_Class_t *CmdDiag, uint64 IntervalNs)
+{
+
+   RPI_BTN_CmdDiagTlm_Payload_t *Payload = &CmdDiag->Tlm.Payload;
+   RPI_BTN_CmdDiagMid_t *TlmMid;
+   CMD_DIAG_Mid_t *Mid;
+   uint8 i;
+
+   Payload->IntervalMs  = IntervalNs / 1000000;
+   Payload->PipeRunHwm  = CmdDiag->RunHwm;
+   Payload->TicksMissed = CmdDiag->TicksMissed;
+
+   for (i=0; i < CMD_DIAG_MID_CNT; i++)
+   {
+
+      Mid    = &CmdDiag->Mid[i];
+      TlmMid = &Payload->Mid[i];
+
+      TlmMid->MsgCnt         = Mid->MsgCnt;
+      TlmMid->QueuedCnt      = Mid->QueuedCnt;
+      TlmMid->MaxWaitUs      = Mid->MaxWaitNs / 1000;
+      TlmMid->MaxDispatchUs  = Mid->MaxDispatchNs / 1000;
+      TlmMid->MeanDispatchUs = (Mid->MsgCnt > 0) ? (Mid->DispatchSumNs / Mid->MsgCnt / 1000) : 0;
+
+   }
+
+   CFE_SB_TimeStampMsg(CFE_MSG_PTR(CmdDiag->Tlm.TelemetryHeader));
+   CFE_SB_TransmitMsg(CFE_MSG_PTR(CmdDiag->Tlm.TelemetryHeader), true);
+
+   memset(CmdDiag->Mid, 0, sizeof(CmdDiag->Mid));
+
+} /* End SendTlm() */
@@ -0,0 +1,180 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the main task command path diagnostics class
+**
+**  Notes:
+**    1. Measures how messages on the app's command pipe are serviced so the
+**       pipe can be sized and main loop starvation detected. CmdDiagTlm is
+**       sent every 1Hz tick when CMD_DIAG_ENABLE is 1.
+**    2. cFE doesn't report a pipe's current depth to the app so the main
+**       task polls the pipe before it blocks. A message returned by the
+**       poll was queued while the previous message was processed. A run is
+**       the messages received back to back before the pipe is empty. The
+**       longest run is an upper bound of the pipe depth high-water mark,
+**       a run shorter than APP_CMD_PIPE_DEPTH means the pipe never filled.
+**    3. Per message ID statistics, times are CLOCK_MONOTONIC:
+**       - Dispatch: Receive to the end of processing
+**       - Wait:     Time a queued message may have waited in the pipe, from
+**                   the start of its run to its receive. An approximate
+**                   upper bound, messages that weren't queued have no wait.
+**    4. Missed 1Hz ticks are derived from the gaps between tick receive
+**       times. A gap of N seconds, rounded, counts N-1 missed ticks. Ticks
+**       that queued behind other messages arrive late and show up as long
+**       waits followed by a short gap.
+**    5. Diagnostics are only collected when enabled. The poll before each
+**       blocking receive is the only change to the command path.
+**
+*/
+
+#ifndef _cmd_diag_
+#define _cmd_diag_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define CMD_DIAG_MID_CNT  (sizeof(((RPI_BTN_CmdDiagTlm_Payload_t *)0)->Mid) / sizeof(RPI_BTN_CmdDiagMid_t))
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+/* Index of a message ID's statistics in CmdDiagTlm */
+typedef enum
+{
+
+   CMD_DIAG_MID_CMD         = 0,
+   CMD_DIAG_MID_ONE_HZ      = 1,
+   CMD_DIAG_MID_STATUS_TICK = 2,   /* Only used when it isn't the 1Hz topic */
+   CMD_DIAG_MID_OTHER       = 3    /* Invalid message IDs */
+
+} CMD_DIAG_MidIdx_t;
+
+
+/******************************************************************************
+** Message ID statistics since the last CmdDiagTlm
+*/
+
+typedef struct
+{
+
+   uint32  MsgCnt;
+   uint32  QueuedCnt;
+   uint64  MaxWaitNs;
+   uint64  MaxDispatchNs;
+   uint64  DispatchSumNs;
+
+} CMD_DIAG_Mid_t;
+
+
+/******************************************************************************
+** CMD_DIAG_Class
+*/
+
+typedef struct
+{
+
+   /*
+   ** Class State Data
+   */
+
+   bool    Enabled;
+
+   uint64  ReceiveNs;          /* Receive time of the message being processed */
+   bool    Queued;
+   uint64  RunStartNs;
+   uint16  RunLen;
+
+   bool    Primed;             /* A 1Hz tick has started an interval */
+   uint64  LastTickNs;
+
+   CMD_DIAG_Mid_t  Mid[CMD_DIAG_MID_CNT];
+
+   /*
+   ** Statistics
+   */
+
+   uint16  RunHwm;
+   uint32  TicksMissed;
+
+   RPI_BTN_CmdDiagTlm_t  Tlm;
+
+} CMD_DIAG_Class_t;
+
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: CMD_DIAG_Constructor
+**
+** Notes:
+**   1. StatusTlmTickMid has its own statistics when it isn't OneHzMid.
+**
+*/
+void CMD_DIAG_Constructor(CMD_DIAG_Class_t *CmdDiag, INITBL_Class_t *IniTbl,
+                          CFE_SB_MsgId_t CmdMid, CFE_SB_MsgId_t OneHzMid,
+                          CFE_SB_MsgId_t StatusTlmTickMid);
+
+
+/******************************************************************************
+** Function: CMD_DIAG_Received
+**
+** Record the receive time of a message.
+**
+** Notes:
+**   1. Queued is true if the message was returned by the poll before the
+**      blocking receive.
+**
+*/
+void CMD_DIAG_Received(CMD_DIAG_Class_t *CmdDiag, bool Queued);
+
+
+/******************************************************************************
+** Function: CMD_DIAG_Processed
+**
+** Record the statistics of the message passed to the last CMD_DIAG_Received()
+** after it has been processed.
+**
+** Notes:
+**   1. A 1Hz tick accounts for the gap since the previous tick and sends
+**      CmdDiagTlm. The first tick starts the first interval.
+**
+*/
+void CMD_DIAG_Processed(CMD_DIAG_Class_t *CmdDiag, CMD_DIAG_MidIdx_t MidIdx);
+
+
+/******************************************************************************
+** Function: CMD_DIAG_ResetStatus
+**
+** Reset the pipe run high-water mark and the missed tick count.
+**
+*/
+void CMD_DIAG_ResetStatus(CMD_DIAG_Class_t *CmdDiag);
+
+
+#endif /* _cmd_diag_ */
@@ -0,0 +1,260 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the Encoder Class methods
+**
+**  Notes:
+**    1. Each edge event gives the new level of one line so the next state
+**       is known without reading the lines. The step is looked up from the
+**       previous and next states.
+**    2. The velocity is measured between the kernel timestamps of the last
+**       edges counted before consecutive telemetry updates so it's accurate
+**       at low speeds. When no edge is counted during an update it decays
+**       towards zero, bounded by one count over the time since the last edge.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+
+#include "encoder.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define LINE_A  0
+#define LINE_B  1
+
+#define STEP_ILLEGAL  2
+
+
+/**********************/
+/** Global File Data **/
+/**********************/
+
+/*
+** Quadrature step indexed by (PrevState << 2) | NextState where a state is
+** (A << 1) | B. The forward sequence is 00, 01, 11, 10. Both lines changing
+** is an illegal transition and so is no change because every edge event
+** must change the level of its line. Either means an edge was missed.
+*/
+static const int8 QuadStep[16] =
+{
+   /*          Next: 00            01            10            11 */
+   /* Prev 00 */     STEP_ILLEGAL, +1,           -1,           STEP_ILLEGAL,
+   /* Prev 01 */     -1,           STEP_ILLEGAL, STEP_ILLEGAL, +1,
+   /* Prev 10 */     +1,           STEP_ILLEGAL, STEP_ILLEGAL, -1,
+   /* Prev 11 */     STEP_ILLEGAL, -1,           +1,           STEP_ILLEGAL
+};
+
+
+/******************************************************************************
+** Function: ENCODER_Constructor
+**
+*/
+bool ENCODER_Constructor(ENCODER_Class_t *Encoder, INITBL_Class_t *IniTbl)
+{
+
+   uint8  Pin[2];
+   uint32 Levels;
+
+   memset(Encoder, 0, sizeof(ENCODER_Class_t));
+
+   PACER_Constructor(&Encoder->TlmPacer, (uint64)INITBL_GetIntConfig(IniTbl, CFG_ENCODER_TLM_MS) * 1000000);
+   Pin[LINE_A] = INITBL_GetIntConfig(IniTbl, CFG_ENCODER_PIN_A);
+   Pin[LINE_B] = INITBL_GetIntConfig(IniTbl, CFG_ENCODER_PIN_B);
+
+   CFE_MSG_Init(CFE_MSG_PTR(Encoder->Tlm.TelemetryHeader),
+                CFE_SB_ValueToMsgId(INITBL_GetIntConfig(IniTbl, CFG_RPI_BTN_ENCODER_TLM_TOPICID)),
+                sizeof(RPI_BTN_EncoderTlm_t));
+
+   if (Encoder->TlmPacer.PeriodNs == 0)
+   {
+      CFE_EVS_SendEvent(ENCODER_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid encoder telemetry period, ENCODER_TLM_MS must be greater than 0");
+   }
+   else if (GPIO_CDEV_Constructor(&Encoder->GpioCdev, INITBL_GetStrConfig(IniTbl, CFG_GPIO_CDEV_CHIP),
+                                  Pin, 2, RPI_BTN_EDGE_BOTH, "rpi_btn encoder"))
+   {
+
+      if (GPIO_CDEV_GetLevels(&Encoder->GpioCdev, &Levels))
+      {
+         Encoder->State = (((Levels >> LINE_A) & 1) << 1) | ((Levels >> LINE_B) & 1);
+      }
+      Encoder->RefEdgeNs  = GPIO_CDEV_NowNs();
+      Encoder->LastEdgeNs = Encoder->RefEdgeNs;
+      PACER_Start(&Encoder->TlmPacer, Encoder->RefEdgeNs);
+      Encoder->Connected  = true;
+
+      CFE_EVS_SendEvent(ENCODER_CONSTRUCTOR_EID, CFE_EVS_EventType_INFORMATION,
+                        "Sucessfully connected to an encoder on GPIO pins %d(A) and %d(B), telemetry every %dms",
+                        Pin[LINE_A], Pin[LINE_B], INITBL_GetIntConfig(IniTbl, CFG_ENCODER_TLM_MS));
+
+   } /* End if lines requested */
+
+   return Encoder->Connected;
+
+} /* End ENCODER_Constructor() */
+
+
+/******************************************************************************
+** Function: ENCODER_ProcessEvents
+**
+** Notes:
+**   1. Reads continue until a partial batch so the kernel queue is empty
+**      when this returns.
+**
+*/
+int ENCODER_ProcessEvents(ENCODER_Class_t *Encoder)
+{
+
+   GPIO_CDEV_Class_t *GpioCdev = &Encoder->GpioCdev;
+   struct gpio_v2_line_event *Event;
+   uint8 NextState;
+   uint8 StateBit;
+   int8  Step;
+   int   EventCnt;
+   int   TotalEventCnt = 0;
+   int   i;
+
+   do
+   {
+
+      EventCnt = GPIO_CDEV_ReadEvents(GpioCdev);
+
+      for (i=0; i < EventCnt; i++)
+      {
+
+         Event = &GpioCdev->Event[i];
+         StateBit  = (Event->offset == GpioCdev->Pin[LINE_A]) ? 2 : 1;
+         NextState = (Event->id == GPIO_V2_LINE_EVENT_RISING_EDGE) ?
+                     (Encoder->State | StateBit) : (Encoder->State & ~StateBit);
+
+         Step = QuadStep[(Encoder->State << 2) | NextState];
+         if (Step == STEP_ILLEGAL)
+         {
+            Encoder->IllegalCnt++;
+         }
+         else
+         {
+            Encoder->Position  += Step;
+            Encoder->LastEdgeNs = Event->timestamp_ns;
+         }
+         Encoder->State = NextState;
+
+      } /* End event loop */
+
+      if (EventCnt > 0)
+      {
+         TotalEventCnt += EventCnt;
+      }
+
+   } while (EventCnt == RPI_BTN_CDEV_READ_BATCH);
+
+   Encoder->LastEdgePosition = Encoder->Position;
+   Encoder->TlmEventCnt     += TotalEventCnt;
+
+   return (EventCnt < 0) ? -1 : TotalEventCnt;
+
+} /* End ENCODER_ProcessEvents() */
+
+
+/******************************************************************************
+** Function: ENCODER_ResetStatus
+**
+*/
+void ENCODER_ResetStatus(ENCODER_Class_t *Encoder)
+{
+
+   Encoder->IllegalCnt = 0;
+   GPIO_CDEV_ResetStatus(&Encoder->GpioCdev);
+
+} /* End ENCODER_ResetStatus() */
+
+
+/******************************************************************************
+** Function: ENCODER_SendTlm
+**
+*/
+void ENCODER_SendTlm(ENCODER_Class_t *Encoder)
+{
+
+   RPI_BTN_EncoderTlm_Payload_t *Payload = &Encoder->Tlm.Payload;
+   uint64 NowNs = GPIO_CDEV_NowNs();
+   float  MaxVelocity;
+
+   if (Encoder->Connected && PACER_Due(&Encoder->TlmPacer, NowNs))
+   {
+
+      if (Encoder->LastEdgeNs > Encoder->RefEdgeNs)
+      {
+         Encoder->Velocity = (float)(Encoder->LastEdgePosition - Encoder->RefEdgePosition) * 1.0e9f /
+                             (float)(Encoder->LastEdgeNs - Encoder->RefEdgeNs);
+         Encoder->RefEdgeNs       = Encoder->LastEdgeNs;
+         Encoder->RefEdgePosition = Encoder->LastEdgePosition;
+      }
+      else if (NowNs > Encoder->LastEdgeNs)
+      {
+         MaxVelocity = 1.0e9f / (float)(NowNs - Encoder->LastEdgeNs);
+         if (Encoder->Velocity > MaxVelocity)
+         {
+            Encoder->Velocity = MaxVelocity;
+         }
+         else if (Encoder->Velocity < -MaxVelocity)
+         {
+            Encoder->Velocity = -MaxVelocity;
+         }
+      }
+
+      Payload->Position      = (int32)Encoder->Position;
+      Payload->PositionDelta = (int32)(Encoder->Position - Encoder->TlmPosition);
+      Payload->Velocity      = Encoder->Velocity;
+      Payload->Edges         = Encoder->TlmEventCnt;
+      Payload->IllegalCnt    = Encoder->IllegalCnt;
+      Payload->LostCnt       = Encoder->GpioCdev.LostCnt;
+
+      CFE_SB_TimeStampMsg(CFE_MSG_PTR(Encoder->Tlm.TelemetryHeader));
+      CFE_SB_TransmitMsg(CFE_MSG_PTR(Encoder->Tlm.TelemetryHeader), true);
+
+      Encoder->TlmPosition = Encoder->Position;
+      Encoder->TlmEventCnt = 0;
+
+   } /* End if update due */
+
+} /* End ENCODER_SendTlm() */
+
+
+/******************************************************************************
+** Function: ENCODER_TimeoutMs
+**
+*/
+int ENCODER_TimeoutMs(const ENCODER_Class_t *Encoder)
+{
+
+   int TimeoutMs = -1;
+
+   if (Encoder->Connected)
+   {
+      TimeoutMs = PACER_TimeoutMs(&Encoder->TlmPacer, GPIO_CDEV_NowNs());
+   }
+
+   return TimeoutMs;
+
+} /* End ENCODER_TimeoutMs() */
@@ -0,0 +1,152 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the Encoder class
+**
+**  Notes:
+**    1. Decodes a quadrature rotary encoder on two GPIO lines requested
+**       from the GPIO character device. Every edge on either line is one
+**       count (4x decoding).
+**    2. The encoder is owned by the Button object and serviced by the
+**       Button child task when BTN_MODE is "encoder". Edges are processed
+**       in batches and EncoderTlm is sent every ENCODER_TLM_MS so the
+**       telemetry rate doesn't depend on how fast the encoder turns.
+**
+*/
+
+#ifndef _encoder_
+#define _encoder_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+#include "gpio_cdev.h"
+#include "pacer.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+
+/*
+** Event Message IDs
+*/
+
+#define ENCODER_CONSTRUCTOR_EID  (ENCODER_BASE_EID + 0)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+/******************************************************************************
+** ENCODER_Class
+*/
+
+typedef struct
+{
+
+   /*
+   ** Class State Data
+   */
+
+   bool    Connected;
+   GPIO_CDEV_Class_t GpioCdev;    /* Line 0 is A, line 1 is B */
+
+   uint8   State;                 /* Bit 1 is the A level, bit 0 is the B level */
+   int64   Position;
+
+   uint64  LastEdgeNs;            /* Kernel timestamp of the last counted edge */
+   int64   LastEdgePosition;
+   uint64  RefEdgeNs;             /* Last counted edge at the previous telemetry update */
+   int64   RefEdgePosition;
+   float   Velocity;              /* Counts per second */
+
+   PACER_Class_t TlmPacer;
+   int64   TlmPosition;           /* Position sent in the previous telemetry packet */
+   uint32  TlmEventCnt;
+
+   /*
+   ** Statistics
+   */
+
+   uint32  IllegalCnt;            /* Edges that didn't produce a valid quadrature step */
+
+   RPI_BTN_EncoderTlm_t Tlm;
+
+} ENCODER_Class_t;
+
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: ENCODER_Constructor
+**
+** Initialize an encoder object to a known state and request its lines.
+**
+** Notes:
+**   1. Returns true if the lines were requested.
+**
+*/
+bool ENCODER_Constructor(ENCODER_Class_t *Encoder, INITBL_Class_t *IniTbl);
+
+
+/******************************************************************************
+** Function: ENCODER_ProcessEvents
+**
+** Drain the queued edge events and update the position.
+**
+** Notes:
+**   1. Returns the number of edges processed or -1 if a read failed.
+**
+*/
+int ENCODER_ProcessEvents(ENCODER_Class_t *Encoder);
+
+
+/******************************************************************************
+** Function: ENCODER_ResetStatus
+**
+** Reset the illegal edge and lost event counts.
+**
+*/
+void ENCODER_ResetStatus(ENCODER_Class_t *Encoder);
+
+
+/******************************************************************************
+** Function: ENCODER_SendTlm
+**
+** Update the velocity estimate and send EncoderTlm if an update is due.
+**
+*/
+void ENCODER_SendTlm(ENCODER_Class_t *Encoder);
+
+
+/******************************************************************************
+** Function: ENCODER_TimeoutMs
+**
+** Return the time in milliseconds until the next telemetry update is due.
+**
+*/
+int ENCODER_TimeoutMs(const ENCODER_Class_t *Encoder);
+
+
+#endif /* _encoder_ */
@@ -0,0 +1,306 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the button event macro Class methods
+**
+**  Notes:
+**    1. See event_macro.h prologue for the table format.
+**    2. The table is parsed with the coreJSON functions included by app_c_fw,
+**       the same parser that loads the ini file.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <ctype.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "event_macro.h"
+#include "event_route.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define QUERY_MAX  32
+
+
+/**********************/
+/** Global File Data **/
+/**********************/
+
+static EVENT_MACRO_Class_t*  EventMacro = NULL;
+
+
+/*******************************/
+/** Local Function Prototypes **/
+/*******************************/
+
+static bool LoadMacro(size_t JsonLen, int MacroIdx);
+static bool LoadJsonData(size_t JsonFileLen);
+static bool ParseHex(const char *HexStr, size_t HexLen, uint8 *Byte);
+static bool SearchMacro(size_t JsonLen, int MacroIdx,
+                        const char *Key, char **Value, size_t *ValueLen);
+
+
+/******************************************************************************
+** Function: EVENT_MACRO_Constructor
+**
+*/
+void EVENT_MACRO_Constructor(EVENT_MACRO_Class_t *EventMacroPtr, const char *Filename)
+{
+
+   EventMacro = EventMacroPtr;
+
+   memset(EventMacro, 0, sizeof(EVENT_MACRO_Class_t));
+
+   if (Filename[0] != '\0')
+   {
+      if (CJSON_ProcessFile(Filename, EventMacro->JsonBuf, RPI_BTN_MACRO_TBL_MAX_CHAR, LoadJsonData))
+      {
+         CFE_EVS_SendEvent(EVENT_MACRO_LOAD_EID, CFE_EVS_EventType_INFORMATION,
+                           "Loaded %d button event macros from %s", EventMacro->MacroCnt, Filename);
+      }
+      else
+      {
+         EventMacro->MacroCnt = 0;
+      }
+   }
+
+} /* End EVENT_MACRO_Constructor() */
+
+
+/******************************************************************************
+** Function: EVENT_MACRO_ResetStatus
+**
+*/
+void EVENT_MACRO_ResetStatus(EVENT_MACRO_Class_t *EventMacroPtr)
+{
+
+   EventMacroPtr->SentCnt    = 0;
+   EventMacroPtr->SendErrCnt = 0;
+
+} /* End EVENT_MACRO_ResetStatus() */
+
+
+/******************************************************************************
+** Function: EVENT_MACRO_Run
+**
+*/
+void EVENT_MACRO_Run(EVENT_MACRO_Class_t *EventMacroPtr, RPI_BTN_ButtonEvent_t Event)
+{
+
+   EVENT_MACRO_Macro_t *Macro;
+   uint8 i;
+
+   for (i=0; i < EventMacroPtr->MacroCnt; i++)
+   {
+
+      Macro = &EventMacroPtr->Macro[i];
+
+      if (Macro->Event == Event)
+      {
+         if (CFE_SB_TransmitMsg(CFE_MSG_PTR(Macro->Cmd.CommandHeader), false) == CFE_SUCCESS)
+         {
+            EventMacroPtr->SentCnt++;
+         }
+         else
+         {
+            EventMacroPtr->SendErrCnt++;
+         }
+      }
+
+   } /* End macro loop */
+
+} /* End EVENT_MACRO_Run() */
+
+
+/******************************************************************************
+** Function: LoadJsonData
+**
+** Notes:
+**   1. Called by CJSON_ProcessFile() after the file has been read into
+**      JsonBuf and validated.
+**   2. The macro array ends at the first index that isn't found.
+**
+*/
+static bool LoadJsonData(size_t JsonFileLen)
+{
+
+   bool   RetStatus = true;
+   int    MacroIdx;
+   char   Query[QUERY_MAX];
+   char  *Value;
+   size_t ValueLen;
+
+   for (MacroIdx=0; RetStatus; MacroIdx++)
+   {
+      snprintf(Query, sizeof(Query), "macro[%d]", MacroIdx);
+      if (JSON_Search(EventMacro->JsonBuf, JsonFileLen, Query, strlen(Query), &Value, &ValueLen) != JSONSuccess)
+      {
+         break;
+      }
+      RetStatus = LoadMacro(JsonFileLen, MacroIdx);
+   }
+
+   return RetStatus;
+
+} /* End LoadJsonData() */
+
+
+/******************************************************************************
+** Function: LoadMacro
+**
+** Parse a macro and build its command packet.
+**
+*/
+static bool LoadMacro(size_t JsonLen, int MacroIdx)
+{
+
+   EVENT_MACRO_Macro_t *Macro;
+   RPI_BTN_ButtonEvent_t Event = 0;
+   unsigned long TopicId  = 0;
+   unsigned long FuncCode = 0;
+   size_t PayloadLen = 0;
+   char  *Value;
+   char  *EndPtr = NULL;
+   size_t ValueLen;
+
+   if (SearchMacro(JsonLen, MacroIdx, "event", &Value, &ValueLen))
+   {
+      Event = EVENT_ROUTE_StrToEvent(Value, ValueLen);
+   }
+   if (Event == 0)
+   {
+      CFE_EVS_SendEvent(EVENT_MACRO_LOAD_EID, CFE_EVS_EventType_ERROR,
+                        "Event macro %d has a missing or invalid event, expected press, release, click, double or long",
+                        MacroIdx);
+      return false;
+   }
+
+   if (SearchMacro(JsonLen, MacroIdx, "topic-id", &Value, &ValueLen))
+   {
+      TopicId = strtoul(Value, &EndPtr, 0);
+   }
+   if (EndPtr == NULL || EndPtr == Value)
+   {
+      CFE_EVS_SendEvent(EVENT_MACRO_LOAD_EID, CFE_EVS_EventType_ERROR,
+                        "Event macro %d has a missing or invalid topic-id", MacroIdx);
+      return false;
+   }
+
+   EndPtr = NULL;
+   if (SearchMacro(JsonLen, MacroIdx, "function-code", &Value, &ValueLen))
+   {
+      FuncCode = strtoul(Value, &EndPtr, 0);
+   }
+   if (EndPtr == NULL || EndPtr == Value || FuncCode > 127)
+   {
+      CFE_EVS_SendEvent(EVENT_MACRO_LOAD_EID, CFE_EVS_EventType_ERROR,
+                        "Event macro %d has a missing or invalid function-code. Valid range [0..127]", MacroIdx);
+      return false;
+   }
+
+   if (EventMacro->MacroCnt >= RPI_BTN_MAX_MACROS)
+   {
+      CFE_EVS_SendEvent(EVENT_MACRO_LOAD_EID, CFE_EVS_EventType_ERROR,
+                        "Event macro table has more than %d macros", RPI_BTN_MAX_MACROS);
+      return false;
+   }
+
+   Macro = &EventMacro->Macro[EventMacro->MacroCnt];
+   memset(Macro, 0, sizeof(EVENT_MACRO_Macro_t));
+
+   /* The payload is optional */
+   if (SearchMacro(JsonLen, MacroIdx, "payload", &Value, &ValueLen))
+   {
+      if ((ValueLen % 2) != 0 || ValueLen > 2 * RPI_BTN_MACRO_MAX_PAYLOAD ||
+          !ParseHex(Value, ValueLen, Macro->Cmd.Payload))
+      {
+         CFE_EVS_SendEvent(EVENT_MACRO_LOAD_EID, CFE_EVS_EventType_ERROR,
+                           "Event macro %d has an invalid payload, expected up to %d bytes as pairs of hex digits",
+                           MacroIdx, RPI_BTN_MACRO_MAX_PAYLOAD);
+         return false;
+      }
+      PayloadLen = ValueLen / 2;
+   }
+
+   Macro->Event = Event;
+   CFE_MSG_Init(CFE_MSG_PTR(Macro->Cmd.CommandHeader), CFE_SB_ValueToMsgId(TopicId),
+                sizeof(CFE_MSG_CommandHeader_t) + PayloadLen);
+   CFE_MSG_SetFcnCode(CFE_MSG_PTR(Macro->Cmd.CommandHeader), FuncCode);
+   CFE_MSG_GenerateChecksum(CFE_MSG_PTR(Macro->Cmd.CommandHeader));
+
+   EventMacro->MacroCnt++;
+
+   return true;
+
+} /* End LoadMacro() */
+
+
+/******************************************************************************
+** Function: ParseHex
+**
+** Convert pairs of hex digits to bytes.
+**
+*/
+static bool ParseHex(const char *HexStr, size_t HexLen, uint8 *Byte)
+{
+
+   char   Pair[3] = { '\0', '\0', '\0' };
+   size_t i;
+
+   for (i=0; i < HexLen; i += 2)
+   {
+      if (!isxdigit((unsigned char)HexStr[i]) || !isxdigit((unsigned char)HexStr[i+1]))
+      {
+         return false;
+      }
+      Pair[0] = HexStr[i];
+      Pair[1] = HexStr[i+1];
+      *Byte++ = (uint8)strtoul(Pair, NULL, 16);
+   }
+
+   return true;
+
+} /* End ParseHex() */
+
+
+/******************************************************************************
+** Function: SearchMacro
+**
+** Find the value of a key in the macro at MacroIdx.
+**
+** Notes:
+**   1. Values aren't null terminated, numbers are followed by a JSON
+**      delimiter so they can be converted in place.
+**
+*/
+static bool SearchMacro(size_t JsonLen, int MacroIdx,
+                        const char *Key, char **Value, size_t *ValueLen)
+{
+
+   char Query[QUERY_MAX];
+
+   snprintf(Query, sizeof(Query), "macro[%d].%s", MacroIdx, Key);
+
+   return (JSON_Search(EventMacro->JsonBuf, JsonLen, Query, strlen(Query), Value, ValueLen) == JSONSuccess);
+
+} /* End SearchMacro() */
@@ -0,0 +1,150 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the button event macro class
+**
+**  Notes:
+**    1. A macro is a software bus command packet sent when a button event
+**       occurs so a button can trigger an on-board action without a
+**       round trip through the ground. The macros are defined in the JSON
+**       file named by the MACRO_TBL_FILE ini configuration:
+**
+**         "macro": [
+**            { "event": "long", "topic-id": 6245, "function-code": 2, "payload": "0100" }
+**         ]
+**
+**       event is press, release, click, double or long, see event_route.h.
+**       topic-id is the command message ID value, the same as the ini
+**       topic IDs. payload is the command payload in hex, the bytes that
+**       follow the command header, and may be empty.
+**    2. Every packet is built and checksummed when the table is loaded so
+**       running a macro is one software bus send of a prebuilt packet. The
+**       sequence count isn't incremented so the checksum stays valid.
+**    3. The table is loaded once by the constructor, there is no load
+**       command.
+**
+*/
+
+#ifndef _event_macro_
+#define _event_macro_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+
+/*
+** Event Message IDs
+*/
+
+#define EVENT_MACRO_LOAD_EID  (EVENT_MACRO_BASE_EID + 0)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+/******************************************************************************
+** Prebuilt command packet
+*/
+
+typedef struct
+{
+
+   CFE_MSG_CommandHeader_t  CommandHeader;
+   uint8                    Payload[RPI_BTN_MACRO_MAX_PAYLOAD];
+
+} EVENT_MACRO_Cmd_t;
+
+typedef struct
+{
+
+   RPI_BTN_ButtonEvent_t  Event;
+   EVENT_MACRO_Cmd_t      Cmd;
+
+} EVENT_MACRO_Macro_t;
+
+
+/******************************************************************************
+** EVENT_MACRO_Class
+*/
+
+typedef struct
+{
+
+   /*
+   ** Class State Data
+   */
+
+   uint8   MacroCnt;
+   EVENT_MACRO_Macro_t  Macro[RPI_BTN_MAX_MACROS];
+
+   char    JsonBuf[RPI_BTN_MACRO_TBL_MAX_CHAR];
+
+   /*
+   ** Statistics
+   */
+
+   uint32  SentCnt;
+   uint32  SendErrCnt;        /* Software bus transmit failures */
+
+} EVENT_MACRO_Class_t;
+
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: EVENT_MACRO_Constructor
+**
+** Load the macro table and build each macro's command packet.
+**
+** Notes:
+**   1. An empty Filename disables the macros. A table error is reported
+**      with an error event and loads no macros.
+**
+*/
+void EVENT_MACRO_Constructor(EVENT_MACRO_Class_t *EventMacroPtr, const char *Filename);
+
+
+/******************************************************************************
+** Function: EVENT_MACRO_ResetStatus
+**
+** Reset the sent and send error counts.
+**
+*/
+void EVENT_MACRO_ResetStatus(EVENT_MACRO_Class_t *EventMacroPtr);
+
+
+/******************************************************************************
+** Function: EVENT_MACRO_Run
+**
+** Send the command packets of the macros defined for Event.
+**
+*/
+void EVENT_MACRO_Run(EVENT_MACRO_Class_t *EventMacroPtr, RPI_BTN_ButtonEvent_t Event);
+
+
+#endif /* _event_macro_ */
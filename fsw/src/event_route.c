@@ -0,0 +1,296 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the button event routing Class methods
+**
+**  Notes:
+**    1. See event_route.h prologue for the route syntax and gestures.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "event_route.h"
+
+
+/**********************/
+/** Global File Data **/
+/**********************/
+
+/* Indexed by RPI_BTN_ButtonEvent_t */
+static const char* EventStr[] = { "", "press", "release", "click", "double", "long" };
+
+
+/*******************************/
+/** Local Function Prototypes **/
+/*******************************/
+
+static void ParseRoutes(EVENT_ROUTE_Class_t *EventRoute, const char *RoutesStr, uint32 DefTopicId);
+static void SendEvent(EVENT_ROUTE_Class_t *EventRoute, RPI_BTN_ButtonEvent_t Event, uint32 EdgeSeq,
+                      uint8 Level, uint32 DurationMs, uint32 PressedCount);
+
+
+/******************************************************************************
+** Function: EVENT_ROUTE_Constructor
+**
+*/
+void EVENT_ROUTE_Constructor(EVENT_ROUTE_Class_t *EventRoute, INITBL_Class_t *IniTbl,
+                             uint8 GpioPin, int Level, EVENT_MACRO_Class_t *EventMacro)
+{
+
+   memset(EventRoute, 0, sizeof(EVENT_ROUTE_Class_t));
+
+   EventRoute->EventMacro    = EventMacro;
+   EventRoute->GpioPin       = GpioPin;
+   EventRoute->ActiveLevel   = (INITBL_GetIntConfig(IniTbl, CFG_BTN_ACTIVE_LEVEL) != 0);
+   EventRoute->LongPressNs   = (uint64)INITBL_GetIntConfig(IniTbl, CFG_GESTURE_LONG_MS) * 1000000;
+   EventRoute->DoubleClickNs = (uint64)INITBL_GetIntConfig(IniTbl, CFG_GESTURE_DOUBLE_MS) * 1000000;
+   EventRoute->Pressed       = (Level == EventRoute->ActiveLevel);
+
+   ParseRoutes(EventRoute, INITBL_GetStrConfig(IniTbl, CFG_BTN_ROUTES),
+               INITBL_GetIntConfig(IniTbl, CFG_RPI_BTN_BUTTON_EVENT_TLM_TOPICID));
+
+   if (EventRoute->RouteCnt > 0)
+   {
+      CFE_EVS_SendEvent(EVENT_ROUTE_CONSTRUCTOR_EID, CFE_EVS_EventType_INFORMATION,
+                        "Routing %d button events for GPIO pin %d", EventRoute->RouteCnt, GpioPin);
+   }
+
+} /* End EVENT_ROUTE_Constructor() */
+
+
+/******************************************************************************
+** Function: EVENT_ROUTE_Edge
+**
+*/
+void EVENT_ROUTE_Edge(EVENT_ROUTE_Class_t *EventRoute, uint32 EdgeSeq, int Level,
+                      uint64 DetectNs, uint32 PressedCount)
+{
+
+   uint64 DurationNs;
+   uint32 DurationMs;
+
+   if (EventRoute->RouteCnt == 0 && EventRoute->EventMacro->MacroCnt == 0)
+   {
+      return;
+   }
+
+   if (Level == EventRoute->ActiveLevel)
+   {
+      if (!EventRoute->Pressed)
+      {
+         EventRoute->Pressed = true;
+         EventRoute->PressNs = DetectNs;
+         SendEvent(EventRoute, RPI_BTN_ButtonEvent_PRESS, EdgeSeq, Level, 0, PressedCount);
+      }
+   }
+   else if (EventRoute->Pressed)
+   {
+
+      EventRoute->Pressed = false;
+      DurationNs = DetectNs - EventRoute->PressNs;
+      DurationMs = (uint32)(DurationNs / 1000000);
+
+      SendEvent(EventRoute, RPI_BTN_ButtonEvent_RELEASE, EdgeSeq, Level, DurationMs, PressedCount);
+
+      if (DurationNs >= EventRoute->LongPressNs)
+      {
+         EventRoute->ClickValid = false;
+         SendEvent(EventRoute, RPI_BTN_ButtonEvent_LONG_PRESS, EdgeSeq, Level, DurationMs, PressedCount);
+      }
+      else
+      {
+         SendEvent(EventRoute, RPI_BTN_ButtonEvent_CLICK, EdgeSeq, Level, DurationMs, PressedCount);
+         if (EventRoute->ClickValid && (DetectNs - EventRoute->LastClickNs) <= EventRoute->DoubleClickNs)
+         {
+            EventRoute->ClickValid = false;
+            SendEvent(EventRoute, RPI_BTN_ButtonEvent_DOUBLE_CLICK, EdgeSeq, Level, DurationMs, PressedCount);
+         }
+         else
+         {
+            EventRoute->ClickValid  = true;
+            EventRoute->LastClickNs = DetectNs;
+         }
+      }
+
+   } /* End if released */
+
+} /* End EVENT_ROUTE_Edge() */
+
+
+/******************************************************************************
+** Function: EVENT_ROUTE_ResetStatus
+**
+*/
+void EVENT_ROUTE_ResetStatus(EVENT_ROUTE_Class_t *EventRoute)
+{
+
+   EventRoute->SendErrCnt = 0;
+
+} /* End EVENT_ROUTE_ResetStatus() */
+
+
+/******************************************************************************
+** Function: EVENT_ROUTE_StrToEvent
+**
+*/
+RPI_BTN_ButtonEvent_t EVENT_ROUTE_StrToEvent(const char *Str, size_t Len)
+{
+
+   int Event;
+
+   for (Event = RPI_BTN_ButtonEvent_LONG_PRESS; Event > 0; Event--)
+   {
+      if (strlen(EventStr[Event]) == Len && strncmp(Str, EventStr[Event], Len) == 0)
+      {
+         break;
+      }
+   }
+
+   return Event;
+
+} /* End EVENT_ROUTE_StrToEvent() */
+
+
+/******************************************************************************
+** Function: ParseRoutes
+**
+** Notes:
+**   1. Parsing stops at the first syntax error, routes parsed before it are
+**      kept.
+**
+*/
+static void ParseRoutes(EVENT_ROUTE_Class_t *EventRoute, const char *RoutesStr, uint32 DefTopicId)
+{
+
+   const char *StrPtr = RoutesStr;
+   const char *RoutePtr;
+   char  *EndPtr;
+   long  Pin;
+   unsigned long TopicId;
+   size_t EventLen;
+   int    Event;
+   EVENT_ROUTE_Route_t *Route;
+
+   while (*StrPtr != '\0')
+   {
+
+      RoutePtr = StrPtr;
+      Pin = strtol(StrPtr, &EndPtr, 10);
+      if (EndPtr == StrPtr || *EndPtr != ':')
+      {
+         break;
+      }
+      StrPtr   = EndPtr + 1;
+      EventLen = strcspn(StrPtr, ":, ");
+      Event    = EVENT_ROUTE_StrToEvent(StrPtr, EventLen);
+      if (Event == 0)
+      {
+         break;
+      }
+      StrPtr += EventLen;
+
+      TopicId = DefTopicId;
+      if (*StrPtr == ':')
+      {
+         TopicId = strtoul(StrPtr + 1, &EndPtr, 0);
+         if (EndPtr == StrPtr + 1)
+         {
+            break;
+         }
+         StrPtr = EndPtr;
+      }
+
+      if (Pin != EventRoute->GpioPin)
+      {
+         CFE_EVS_SendEvent(EVENT_ROUTE_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                           "Ignoring %s route for GPIO pin %ld, the button is on pin %d",
+                           EventStr[Event], Pin, EventRoute->GpioPin);
+      }
+      else if (EventRoute->RouteCnt >= RPI_BTN_MAX_ROUTES)
+      {
+         CFE_EVS_SendEvent(EVENT_ROUTE_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                           "Ignoring %s route to topic %lu, more than %d routes",
+                           EventStr[Event], TopicId, RPI_BTN_MAX_ROUTES);
+      }
+      else
+      {
+         Route = &EventRoute->Route[EventRoute->RouteCnt++];
+         Route->Event = Event;
+         CFE_MSG_Init(CFE_MSG_PTR(Route->Tlm.TelemetryHeader), CFE_SB_ValueToMsgId(TopicId),
+                      sizeof(RPI_BTN_ButtonEventTlm_t));
+         Route->Tlm.Payload.GpioPin = EventRoute->GpioPin;
+         Route->Tlm.Payload.Event   = Event;
+      }
+
+      while (*StrPtr == ',' || *StrPtr == ' ')
+      {
+         StrPtr++;
+      }
+
+   } /* End while */
+
+   if (*StrPtr != '\0')
+   {
+      CFE_EVS_SendEvent(EVENT_ROUTE_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid BTN_ROUTES syntax at '%s', expected pin:event[:topic] with event "
+                        "press, release, click, double or long", RoutePtr);
+   }
+
+} /* End ParseRoutes() */
+
+
+/******************************************************************************
+** Function: SendEvent
+**
+*/
+static void SendEvent(EVENT_ROUTE_Class_t *EventRoute, RPI_BTN_ButtonEvent_t Event, uint32 EdgeSeq,
+                      uint8 Level, uint32 DurationMs, uint32 PressedCount)
+{
+
+   EVENT_ROUTE_Route_t *Route;
+   uint8 i;
+
+   for (i=0; i < EventRoute->RouteCnt; i++)
+   {
+
+      Route = &EventRoute->Route[i];
+
+      if (Route->Event == Event)
+      {
+
+         Route->Tlm.Payload.EdgeSeq      = EdgeSeq;
+         Route->Tlm.Payload.Level        = Level;
+         Route->Tlm.Payload.DurationMs   = DurationMs;
+         Route->Tlm.Payload.PressedCount = PressedCount;
+
+         CFE_SB_TimeStampMsg(CFE_MSG_PTR(Route->Tlm.TelemetryHeader));
+         if (CFE_SB_TransmitMsg(CFE_MSG_PTR(Route->Tlm.TelemetryHeader), true) != CFE_SUCCESS)
+         {
+            EventRoute->SendErrCnt++;
+         }
+
+      }
+
+   } /* End route loop */
+
+   EVENT_MACRO_Run(EventRoute->EventMacro, Event);
+
+} /* End SendEvent() */
@@ -0,0 +1,181 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the button event routing class
+**
+**  Notes:
+**    1. Turns button edges into press, release and gesture events and
+**       sends each event on the software bus topics routed to it by the
+**       BTN_ROUTES ini configuration. Subscribers receive only the events
+**       they're routed.
+**    2. BTN_ROUTES is a comma separated list of "pin:event[:topic]" routes
+**       where event is press, release, click, double or long. A route
+**       without a topic uses RPI_BTN_BUTTON_EVENT_TLM_TOPICID. An event may
+**       have several routes.
+**    3. Gestures are recognized when the button is released so no timer
+**       is needed:
+**       - long:   Held for at least GESTURE_LONG_MS
+**       - click:  Held for less than GESTURE_LONG_MS
+**       - double: A click released within GESTURE_DOUBLE_MS of the previous
+**                 click's release, the click is also sent
+**       Press and release require BTN_EDGE "both" for gestures.
+**    4. Every route's message header is initialized by the constructor so
+**       sending an event only fills the payload and time stamps it.
+**    5. Each event also runs the event macros defined for it, see
+**       event_macro.h.
+**
+*/
+
+#ifndef _event_route_
+#define _event_route_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+#include "event_macro.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+
+/*
+** Event Message IDs
+*/
+
+#define EVENT_ROUTE_CONSTRUCTOR_EID  (EVENT_ROUTE_BASE_EID + 0)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+/******************************************************************************
+** Route
+*/
+
+typedef struct
+{
+
+   RPI_BTN_ButtonEvent_t     Event;
+   RPI_BTN_ButtonEventTlm_t  Tlm;    /* Header initialized for the route's topic */
+
+} EVENT_ROUTE_Route_t;
+
+
+/******************************************************************************
+** EVENT_ROUTE_Class
+*/
+
+typedef struct
+{
+
+   /*
+   ** Framework References
+   */
+
+   EVENT_MACRO_Class_t *EventMacro;
+
+
+   /*
+   ** Class State Data
+   */
+
+   uint8   GpioPin;
+   uint8   ActiveLevel;
+   uint64  LongPressNs;
+   uint64  DoubleClickNs;
+
+   uint8   RouteCnt;
+   EVENT_ROUTE_Route_t Route[RPI_BTN_MAX_ROUTES];
+
+   bool    Pressed;
+   uint64  PressNs;
+   bool    ClickValid;        /* LastClickNs can start a double click */
+   uint64  LastClickNs;
+
+   /*
+   ** Statistics
+   */
+
+   uint32  SendErrCnt;        /* Software bus transmit failures */
+
+} EVENT_ROUTE_Class_t;
+
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: EVENT_ROUTE_Constructor
+**
+** Parse the routes and initialize a message for each of them.
+**
+** Notes:
+**   1. Level is the button level when the constructor is called, it
+**      determines whether the first edge is a press or a release.
+**   2. Routes for other pins and invalid routes are reported with an error
+**      event and ignored.
+**   3. EventMacro must be constructed first.
+**
+*/
+void EVENT_ROUTE_Constructor(EVENT_ROUTE_Class_t *EventRoute, INITBL_Class_t *IniTbl,
+                             uint8 GpioPin, int Level, EVENT_MACRO_Class_t *EventMacro);
+
+
+/******************************************************************************
+** Function: EVENT_ROUTE_Edge
+**
+** Derive events from a button edge and send the routed messages.
+**
+** Notes:
+**   1. DetectNs is the CLOCK_MONOTONIC time the edge was detected.
+**   2. An edge that doesn't change the pressed state, for example when
+**      the edge after a sysfs read was coalesced, is ignored.
+**   3. EdgeSeq is sent in every message derived from the edge. A subscriber
+**      to both press and release sees consecutive numbers unless edges
+**      were lost.
+**
+*/
+void EVENT_ROUTE_Edge(EVENT_ROUTE_Class_t *EventRoute, uint32 EdgeSeq, int Level,
+                      uint64 DetectNs, uint32 PressedCount);
+
+
+/******************************************************************************
+** Function: EVENT_ROUTE_ResetStatus
+**
+** Reset the send error count.
+**
+*/
+void EVENT_ROUTE_ResetStatus(EVENT_ROUTE_Class_t *EventRoute);
+
+
+/******************************************************************************
+** Function: EVENT_ROUTE_StrToEvent
+**
+** Return the event named by the first Len characters of Str, 0 if it isn't
+** press, release, click, double or long.
+**
+*/
+RPI_BTN_ButtonEvent_t EVENT_ROUTE_StrToEvent(const char *Str, size_t Len);
+
+
+#endif /* _event_route_ */
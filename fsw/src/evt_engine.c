@@ -0,0 +1,643 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the Event Engine Class methods
+**
+**  Notes:
+**    1. sysfs reports an edge with POLLPRI and the notification stays
+**       pending until the value file is read. Both engines read the value
+**       with a positional read at offset 0 so no lseek() is needed.
+**    2. The io_uring engine uses the following flow for each wait
+**       - Submit pending requests and wait for at least one completion
+**       - A poll completion requests a value read for the line
+**       - Requested reads are submitted together and harvested in one wait
+**       Multishot polls are only re-armed when the kernel terminates them.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include "evt_engine.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+/* The line count is a constant for a fixed profile so the line loops collapse */
+#if RPI_BTN_FIXED_PROFILE
+   #define LINE_CNT(EvtEngine)  EVT_ENGINE_MAX_LINES
+#else
+   #define LINE_CNT(EvtEngine)  ((EvtEngine)->LineCnt)
+#endif
+
+/* sysfs values are '0' or '1' so the level is the low bit of the character */
+#define VALUE_TO_LEVEL(ValueChar)  ((ValueChar) & 1)
+
+#ifdef RPI_BTN_IO_URING_ENGINE
+
+/* io_uring user data identifies the request type and line */
+#define URING_OP_POLL  1
+#define URING_OP_READ  2
+#define URING_OP_WAKE  3
+
+#define URING_USER_DATA(Op, Line)  (((uint64)(Op) << 16) | (uint64)(Line))
+#define URING_USER_OP(Data)        ((uint16)((Data) >> 16))
+#define URING_USER_LINE(Data)      ((uint16)((Data) & 0xFFFF))
+
+#endif
+
+
+/*******************************/
+/** Local Function Prototypes **/
+/*******************************/
+
+static int  AddFile(EVT_ENGINE_Class_t *EvtEngine, int FileDescr, bool EventFile);
+static int  PollWait(EVT_ENGINE_Class_t *EvtEngine, EVT_ENGINE_Edge_t *Edges, 
+                     int MaxEdges, int TimeoutMs, bool *WakeRequested);
+
+#ifdef RPI_BTN_IO_URING_ENGINE
+static bool UringCreate(EVT_ENGINE_Class_t *EvtEngine);
+static bool UringArmPoll(EVT_ENGINE_Class_t *EvtEngine, uint16 Line);
+static bool UringArmWake(EVT_ENGINE_Class_t *EvtEngine);
+static void UringQueueReads(EVT_ENGINE_Class_t *EvtEngine);
+static int  UringHarvest(EVT_ENGINE_Class_t *EvtEngine, EVT_ENGINE_Edge_t *Edges, 
+                         int EdgeCnt, int MaxEdges, bool *WakeRequested);
+static int  UringWait(EVT_ENGINE_Class_t *EvtEngine, EVT_ENGINE_Edge_t *Edges, 
+                      int MaxEdges, int TimeoutMs, bool *WakeRequested);
+#endif
+
+
+/******************************************************************************
+** Function: EVT_ENGINE_Constructor
+**
+*/
+bool EVT_ENGINE_Constructor(EVT_ENGINE_Class_t *EvtEngine, const char *EngineStr)
+{
+
+   bool RetStatus = false;
+   
+   int Line;
+   
+   memset(EvtEngine, 0, sizeof(EVT_ENGINE_Class_t));
+   
+   EvtEngine->Type = EVT_ENGINE_POLL;
+   
+   /* poll() ignores negative descriptors so unused lines are never polled */
+   for (Line=0; Line < EVT_ENGINE_MAX_LINES; Line++)
+   {
+      EvtEngine->PollFileDescr[Line+1].fd = -1;
+   }
+   
+   /* Blocking so io_uring waits for a wakeup rather than completing with EAGAIN */
+   EvtEngine->WakeFileDescr = eventfd(0, EFD_CLOEXEC);
+   
+   if (EvtEngine->WakeFileDescr >= 0)
+   {
+   
+      EvtEngine->PollFileDescr[0].fd     = EvtEngine->WakeFileDescr;
+      EvtEngine->PollFileDescr[0].events = POLLIN;
+      RetStatus = true;
+
+#if RPI_BTN_FIXED_PROFILE
+   #if (RPI_BTN_FIXED_ENGINE == RPI_BTN_ENGINE_IO_URING)
+      EvtEngine->Type = EVT_ENGINE_IO_URING;
+      RetStatus = UringCreate(EvtEngine);
+   #endif
+#else
+      if (strcmp(EngineStr, EVT_ENGINE_IO_URING_STR) == 0)
+      {
+#ifdef RPI_BTN_IO_URING_ENGINE
+         if (UringCreate(EvtEngine))
+         {
+            EvtEngine->Type = EVT_ENGINE_IO_URING;
+         }
+#else
+         CFE_EVS_SendEvent(EVT_ENGINE_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR, 
+                           "%s event engine not included in the build, using %s",
+                           EVT_ENGINE_IO_URING_STR, EVT_ENGINE_POLL_STR);
+#endif
+      }
+      else if (strcmp(EngineStr, EVT_ENGINE_POLL_STR) != 0)
+      {
+         CFE_EVS_SendEvent(EVT_ENGINE_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR, 
+                           "Invalid event engine '%s', using %s", EngineStr, EVT_ENGINE_POLL_STR);
+      }
+#endif
+   
+   } /* End if eventfd created */
+   else
+   {
+      CFE_EVS_SendEvent(EVT_ENGINE_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR, 
+                        "Failed to create event engine wakeup eventfd, errno %d", errno);
+   }
+   
+   return RetStatus;
+   
+} /* End EVT_ENGINE_Constructor() */
+
+
+/******************************************************************************
+** Function: EVT_ENGINE_AddEventFile
+**
+*/
+int EVT_ENGINE_AddEventFile(EVT_ENGINE_Class_t *EvtEngine, int FileDescr)
+{
+
+   return AddFile(EvtEngine, FileDescr, true);
+   
+} /* End EVT_ENGINE_AddEventFile() */
+
+
+/******************************************************************************
+** Function: EVT_ENGINE_AddLine
+**
+*/
+int EVT_ENGINE_AddLine(EVT_ENGINE_Class_t *EvtEngine, int FileDescr)
+{
+
+   return AddFile(EvtEngine, FileDescr, false);
+   
+} /* End EVT_ENGINE_AddLine() */
+
+
+/******************************************************************************
+** Function: EVT_ENGINE_ResetStatus
+**
+*/
+void EVT_ENGINE_ResetStatus(EVT_ENGINE_Class_t *EvtEngine)
+{
+
+   EvtEngine->WakeCnt    = 0;
+   EvtEngine->SyscallCnt = 0;
+   EvtEngine->EdgeCnt    = 0;
+   EvtEngine->MergedCnt  = 0;
+   EvtEngine->OverrunCnt = 0;
+
+} /* End EVT_ENGINE_ResetStatus() */
+
+
+/******************************************************************************
+** Function: EVT_ENGINE_TypeStr
+**
+*/
+const char *EVT_ENGINE_TypeStr(EVT_ENGINE_Type_t Type)
+{
+
+   return (Type == EVT_ENGINE_IO_URING) ? EVT_ENGINE_IO_URING_STR : EVT_ENGINE_POLL_STR;
+
+} /* End EVT_ENGINE_TypeStr() */
+
+
+/******************************************************************************
+** Function: EVT_ENGINE_Wait
+**
+*/
+int EVT_ENGINE_Wait(EVT_ENGINE_Class_t *EvtEngine, EVT_ENGINE_Edge_t *Edges, 
+                    int MaxEdges, int TimeoutMs, bool *WakeRequested)
+{
+
+   int EdgeCnt;
+   
+   *WakeRequested = false;
+   
+#if RPI_BTN_FIXED_PROFILE
+   #if (RPI_BTN_FIXED_ENGINE == RPI_BTN_ENGINE_IO_URING)
+   EdgeCnt = UringWait(EvtEngine, Edges, MaxEdges, TimeoutMs, WakeRequested);
+   #else
+   EdgeCnt = PollWait(EvtEngine, Edges, MaxEdges, TimeoutMs, WakeRequested);
+   #endif
+#else
+   #ifdef RPI_BTN_IO_URING_ENGINE
+   if (EvtEngine->Type == EVT_ENGINE_IO_URING)
+   {
+      EdgeCnt = UringWait(EvtEngine, Edges, MaxEdges, TimeoutMs, WakeRequested);
+   }
+   else
+   #endif
+   {
+      EdgeCnt = PollWait(EvtEngine, Edges, MaxEdges, TimeoutMs, WakeRequested);
+   }
+#endif
+   
+   EvtEngine->WakeCnt++;
+   if (EdgeCnt > 0)
+   {
+      EvtEngine->EdgeCnt += EdgeCnt;
+   }
+   
+   return EdgeCnt;
+   
+} /* End EVT_ENGINE_Wait() */
+
+
+/******************************************************************************
+** Function: EVT_ENGINE_Wake
+**
+*/
+void EVT_ENGINE_Wake(EVT_ENGINE_Class_t *EvtEngine)
+{
+
+   uint64 One = 1;
+   
+   if (write(EvtEngine->WakeFileDescr, &One, sizeof(One)) != sizeof(One))
+   {
+      CFE_EVS_SendEvent(EVT_ENGINE_WAKE_EID, CFE_EVS_EventType_ERROR, 
+                        "Failed to write event engine wakeup eventfd, errno %d", errno);
+   }
+   
+} /* End EVT_ENGINE_Wake() */
+
+
+/******************************************************************************
+** Function: AddFile
+**
+** Add a sysfs value file polled for POLLPRI or an event file polled for
+** POLLIN.
+**
+*/
+static int AddFile(EVT_ENGINE_Class_t *EvtEngine, int FileDescr, bool EventFile)
+{
+
+   int Line = -1;
+   
+   if (EvtEngine->LineCnt < EVT_ENGINE_MAX_LINES)
+   {
+   
+      Line = EvtEngine->LineCnt++;
+      EvtEngine->LineFileDescr[Line] = FileDescr;
+      EvtEngine->EventFile[Line]     = EventFile;
+      EvtEngine->PollFileDescr[Line+1].fd      = FileDescr;
+      EvtEngine->PollFileDescr[Line+1].events  = EventFile ? POLLIN : POLLPRI;
+      EvtEngine->PollFileDescr[Line+1].revents = 0;
+      
+#ifdef RPI_BTN_IO_URING_ENGINE
+      if (EvtEngine->Type == EVT_ENGINE_IO_URING)
+      {
+         UringArmPoll(EvtEngine, Line);
+      }
+#endif
+   }
+   else
+   {
+      CFE_EVS_SendEvent(EVT_ENGINE_ADD_LINE_EID, CFE_EVS_EventType_ERROR, 
+                        "Failed to add line, the maximum of %d lines are defined", EVT_ENGINE_MAX_LINES);
+   }
+   
+   return Line;
+   
+} /* End AddFile() */
+
+
+/******************************************************************************
+** Function: PollWait
+**
+*/
+static int PollWait(EVT_ENGINE_Class_t *EvtEngine, EVT_ENGINE_Edge_t *Edges, 
+                    int MaxEdges, int TimeoutMs, bool *WakeRequested)
+{
+
+   int    Status;
+   int    EdgeCnt = 0;
+   uint16 Line;
+   uint64 WakeCnt;
+   char   ValueStr[3];
+   
+   Status = poll(EvtEngine->PollFileDescr, LINE_CNT(EvtEngine) + 1, TimeoutMs);
+   EvtEngine->SyscallCnt++;
+   
+   if (Status > 0)
+   {
+      
+      for (Line=0; (Line < LINE_CNT(EvtEngine)) && (EdgeCnt < MaxEdges); Line++)
+      {
+         if (EvtEngine->EventFile[Line])
+         {
+            if (EvtEngine->PollFileDescr[Line+1].revents & POLLIN)
+            {
+               Edges[EdgeCnt].Line  = Line;
+               Edges[EdgeCnt].Level = EVT_ENGINE_LEVEL_EVENTS;
+               EdgeCnt++;
+            }
+         }
+         else if (EvtEngine->PollFileDescr[Line+1].revents & POLLPRI)
+         {
+            EvtEngine->SyscallCnt++;
+            if (pread(EvtEngine->LineFileDescr[Line], ValueStr, sizeof(ValueStr), 0) > 0)
+            {
+               Edges[EdgeCnt].Line  = Line;
+               Edges[EdgeCnt].Level = VALUE_TO_LEVEL(ValueStr[0]);
+               EdgeCnt++;
+            }
+         }
+      } /* End line loop */
+      
+      if (EvtEngine->PollFileDescr[0].revents & POLLIN)
+      {
+         EvtEngine->SyscallCnt++;
+         if (read(EvtEngine->WakeFileDescr, &WakeCnt, sizeof(WakeCnt)) == sizeof(WakeCnt))
+         {
+            *WakeRequested = true;
+         }
+      }
+   
+   } /* End if poll events */
+   else if ((Status < 0) && (errno != EINTR))
+   {
+      EdgeCnt = -1;
+   }
+   
+   return EdgeCnt;
+   
+} /* End PollWait() */
+
+
+#ifdef RPI_BTN_IO_URING_ENGINE
+
+/******************************************************************************
+** Function: UringCreate
+**
+*/
+static bool UringCreate(EVT_ENGINE_Class_t *EvtEngine)
+{
+
+   int Status = io_uring_queue_init(EVT_ENGINE_URING_DEPTH, &EvtEngine->Ring, 0);
+   
+   if (Status == 0)
+   {
+      EvtEngine->RingCreated = true;
+      UringArmWake(EvtEngine);
+   }
+   else
+   {
+      CFE_EVS_SendEvent(EVT_ENGINE_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR, 
+                        "Failed to create io_uring, status %d", Status);
+   }
+   
+   return EvtEngine->RingCreated;
+   
+} /* End UringCreate() */
+
+
+/******************************************************************************
+** Function: UringArmPoll
+**
+** Queue a multishot poll for a line. It's submitted with the next wait.
+**
+*/
+static bool UringArmPoll(EVT_ENGINE_Class_t *EvtEngine, uint16 Line)
+{
+
+   struct io_uring_sqe *Sqe = io_uring_get_sqe(&EvtEngine->Ring);
+   
+   if (Sqe != NULL)
+   {
+      io_uring_prep_poll_multishot(Sqe, EvtEngine->LineFileDescr[Line], 
+                                   EvtEngine->EventFile[Line] ? POLLIN : POLLPRI);
+      io_uring_sqe_set_data64(Sqe, URING_USER_DATA(URING_OP_POLL, Line));
+   }
+   
+   return (Sqe != NULL);
+   
+} /* End UringArmPoll() */
+
+
+/******************************************************************************
+** Function: UringArmWake
+**
+** Queue a read of the wakeup eventfd. It's re-armed after each completion.
+**
+*/
+static bool UringArmWake(EVT_ENGINE_Class_t *EvtEngine)
+{
+
+   struct io_uring_sqe *Sqe = io_uring_get_sqe(&EvtEngine->Ring);
+   
+   if (Sqe != NULL)
+   {
+      io_uring_prep_read(Sqe, EvtEngine->WakeFileDescr, &EvtEngine->WakeBuf, sizeof(EvtEngine->WakeBuf), 0);
+      io_uring_sqe_set_data64(Sqe, URING_USER_DATA(URING_OP_WAKE, 0));
+   }
+   
+   return (Sqe != NULL);
+   
+} /* End UringArmWake() */
+
+
+/******************************************************************************
+** Function: UringQueueReads
+**
+** Queue a value read for each line that reported an edge, hasn't been read
+** during this wait and doesn't already have a read in flight.
+**
+*/
+static void UringQueueReads(EVT_ENGINE_Class_t *EvtEngine)
+{
+
+   struct io_uring_sqe *Sqe;
+   uint16 Line;
+   
+   for (Line=0; Line < LINE_CNT(EvtEngine); Line++)
+   {
+      if (EvtEngine->ReadRequested[Line] && !EvtEngine->ReadInFlight[Line] && !EvtEngine->ReadDone[Line])
+      {
+         Sqe = io_uring_get_sqe(&EvtEngine->Ring);
+         if (Sqe != NULL)
+         {
+            io_uring_prep_read(Sqe, EvtEngine->LineFileDescr[Line], EvtEngine->LineBuf[Line], 
+                               sizeof(EvtEngine->LineBuf[Line]), 0);
+            io_uring_sqe_set_data64(Sqe, URING_USER_DATA(URING_OP_READ, Line));
+            EvtEngine->ReadRequested[Line] = false;
+            EvtEngine->ReadInFlight[Line]  = true;
+            EvtEngine->ReadsInFlight++;
+         }
+      }
+   } /* End line loop */
+   
+} /* End UringQueueReads() */
+
+
+/******************************************************************************
+** Function: UringHarvest
+**
+** Process all available completions and return the updated edge count.
+**
+*/
+static int UringHarvest(EVT_ENGINE_Class_t *EvtEngine, EVT_ENGINE_Edge_t *Edges, 
+                        int EdgeCnt, int MaxEdges, bool *WakeRequested)
+{
+
+   struct io_uring_cqe *Cqe;
+   unsigned int Head;
+   unsigned int CqeCnt = 0;
+   uint64 UserData;
+   uint16 Line;
+   
+   io_uring_for_each_cqe(&EvtEngine->Ring, Head, Cqe)
+   {
+      
+      CqeCnt++;
+      UserData = io_uring_cqe_get_data64(Cqe);
+      Line = URING_USER_LINE(UserData);
+      
+      switch (URING_USER_OP(UserData))
+      {
+         case URING_OP_POLL:
+            if (Cqe->res > 0)
+            {
+               if (!EvtEngine->EventFile[Line])
+               {
+                  if (EvtEngine->ReadRequested[Line])
+                  {
+                     EvtEngine->MergedCnt++;
+                  }
+                  EvtEngine->ReadRequested[Line] = true;
+               }
+               else if (!EvtEngine->ReadDone[Line])
+               {
+                  /* Nothing to read, report the event file once per wait */
+                  EvtEngine->ReadDone[Line] = true;
+                  if (EdgeCnt < MaxEdges)
+                  {
+                     Edges[EdgeCnt].Line  = Line;
+                     Edges[EdgeCnt].Level = EVT_ENGINE_LEVEL_EVENTS;
+                     EdgeCnt++;
+                  }
+                  else
+                  {
+                     EvtEngine->OverrunCnt++;
+                  }
+               }
+            }
+            if (!(Cqe->flags & IORING_CQE_F_MORE))
+            {
+               UringArmPoll(EvtEngine, Line);
+            }
+            break;
+            
+         case URING_OP_READ:
+            EvtEngine->ReadInFlight[Line] = false;
+            EvtEngine->ReadDone[Line] = true;
+            EvtEngine->ReadsInFlight--;
+            if (Cqe->res > 0)
+            {
+               if (EdgeCnt < MaxEdges)
+               {
+                  Edges[EdgeCnt].Line  = Line;
+                  Edges[EdgeCnt].Level = VALUE_TO_LEVEL(EvtEngine->LineBuf[Line][0]);
+                  EdgeCnt++;
+               }
+               else
+               {
+                  EvtEngine->OverrunCnt++;
+               }
+            }
+            break;
+            
+         case URING_OP_WAKE:
+            if (Cqe->res == sizeof(EvtEngine->WakeBuf))
+            {
+               *WakeRequested = true;
+            }
+            UringArmWake(EvtEngine);
+            break;
+            
+         default:
+            break;
+      
+      } /* End op switch */
+      
+   } /* End CQE loop */
+   
+   io_uring_cq_advance(&EvtEngine->Ring, CqeCnt);
+   
+   return EdgeCnt;
+   
+} /* End UringHarvest() */
+
+
+/******************************************************************************
+** Function: UringWait
+**
+** Notes:
+**   1. Reads requested by the previous wait that couldn't be completed are
+**      submitted with this wait's first kernel entry.
+**   2. A line is read at most once per wait. A poll completion for a line
+**      that was already read is carried into the next wait.
+**
+*/
+static int UringWait(EVT_ENGINE_Class_t *EvtEngine, EVT_ENGINE_Edge_t *Edges, 
+                     int MaxEdges, int TimeoutMs, bool *WakeRequested)
+{
+
+   struct io_uring_cqe *Cqe;
+   struct __kernel_timespec Timeout;
+   struct __kernel_timespec *TimeoutPtr = NULL;
+   int Status;
+   int EdgeCnt = 0;
+   
+   memset(EvtEngine->ReadDone, 0, sizeof(EvtEngine->ReadDone));
+   
+   if (TimeoutMs >= 0)
+   {
+      Timeout.tv_sec  = TimeoutMs / 1000;
+      Timeout.tv_nsec = (TimeoutMs % 1000) * 1000000L;
+      TimeoutPtr = &Timeout;
+   }
+   
+   UringQueueReads(EvtEngine);
+   Status = io_uring_submit_and_wait_timeout(&EvtEngine->Ring, &Cqe, 1, TimeoutPtr, NULL);
+   EvtEngine->SyscallCnt++;
+   
+   if ((Status >= 0) || (Status == -ETIME))
+   {
+   
+      EdgeCnt = UringHarvest(EvtEngine, Edges, EdgeCnt, MaxEdges, WakeRequested);
+      UringQueueReads(EvtEngine);
+      
+      while (EvtEngine->ReadsInFlight > 0)
+      {
+         
+         Status = io_uring_submit_and_wait(&EvtEngine->Ring, EvtEngine->ReadsInFlight);
+         EvtEngine->SyscallCnt++;
+         if ((Status < 0) && (Status != -EINTR))
+         {
+            EdgeCnt = -1;
+            break;
+         }
+         
+         EdgeCnt = UringHarvest(EvtEngine, Edges, EdgeCnt, MaxEdges, WakeRequested);
+         UringQueueReads(EvtEngine);
+      
+      } /* End while reads in flight */
+   
+   } /* End if wait completed */
+   else if (Status != -EINTR)
+   {
+      EdgeCnt = -1;
+   }
+   
+   return EdgeCnt;
+   
+} /* End UringWait() */
+
+#endif /* RPI_BTN_IO_URING_ENGINE */
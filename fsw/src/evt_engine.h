@@ -0,0 +1,256 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the Event Engine class
+**
+**  Notes:
+**    1. The event engine waits for edges on sysfs GPIO value files and for
+**       wakeup requests from other tasks. It is owned and run by a child
+**       task, only EVT_ENGINE_Wake() may be called from another task.
+**    2. Two engines are provided:
+**       - poll:     One poll() per wakeup plus one pread() per edge
+**       - io_uring: Multishot polls stay armed on the line files and the
+**                   value reads for every line that fired are submitted
+**                   and harvested as a batch. Only available when the app
+**                   is built with RPI_BTN_IO_URING_ENGINE (see CMakeLists.txt).
+**    3. SyscallCnt counts the kernel entries made by the engine so the
+**       engines can be compared on a target.
+**    4. When RPI_BTN_FIXED_PROFILE is set the engine type is selected at
+**       compile time and the engine handles a single line.
+**    5. Lines are either sysfs value files, which the engine reads, or
+**       event files such as a GPIO character device line request. An event
+**       file is reported with EVT_ENGINE_LEVEL_EVENTS and the owner reads
+**       and drains the queued events.
+**    6. Edges the engine loses are counted in MergedCnt and OverrunCnt so
+**       owners can attribute gaps in their edge sequence to the engine.
+**
+*/
+
+#ifndef _evt_engine_
+#define _evt_engine_
+
+/*
+** Includes
+*/
+
+#include <poll.h>
+#include "app_cfg.h"
+
+#ifdef RPI_BTN_IO_URING_ENGINE
+#include <liburing.h>
+#endif
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#if RPI_BTN_FIXED_PROFILE
+   #define EVT_ENGINE_MAX_LINES  1
+   #if (RPI_BTN_FIXED_ENGINE == RPI_BTN_ENGINE_IO_URING) && !defined(RPI_BTN_IO_URING_ENGINE)
+      #error RPI_BTN_FIXED_ENGINE io_uring requires the RPI_BTN_IO_URING_ENGINE build option
+   #endif
+#else
+   #define EVT_ENGINE_MAX_LINES  8
+#endif
+#define EVT_ENGINE_URING_DEPTH 32   /* Must hold a poll and a read for every line plus the wake read */
+
+#define EVT_ENGINE_LEVEL_EVENTS  0xFFFF   /* Edge level reported for an event file */
+
+#define EVT_ENGINE_POLL_STR     "poll"
+#define EVT_ENGINE_IO_URING_STR "io_uring"
+
+
+/*
+** Event Message IDs
+*/
+
+#define EVT_ENGINE_CONSTRUCTOR_EID  (EVT_ENGINE_BASE_EID + 0)
+#define EVT_ENGINE_ADD_LINE_EID     (EVT_ENGINE_BASE_EID + 1)
+#define EVT_ENGINE_WAKE_EID         (EVT_ENGINE_BASE_EID + 2)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+typedef enum
+{
+
+   EVT_ENGINE_POLL     = RPI_BTN_ENGINE_POLL,
+   EVT_ENGINE_IO_URING = RPI_BTN_ENGINE_IO_URING
+
+} EVT_ENGINE_Type_t;
+
+
+/******************************************************************************
+** Edge reported by EVT_ENGINE_Wait()
+*/
+
+typedef struct
+{
+
+   uint16  Line;    /* Index returned by EVT_ENGINE_AddLine() */
+   uint16  Level;   /* Value read after the edge or EVT_ENGINE_LEVEL_EVENTS */
+   
+} EVT_ENGINE_Edge_t;
+
+
+/******************************************************************************
+** EVT_ENGINE_Class
+*/
+
+typedef struct
+{
+
+   /*
+   ** Class State Data
+   */
+   
+   EVT_ENGINE_Type_t Type;
+   
+   int     WakeFileDescr;      /* eventfd written by EVT_ENGINE_Wake() */
+   uint16  LineCnt;
+   int     LineFileDescr[EVT_ENGINE_MAX_LINES];
+   bool    EventFile[EVT_ENGINE_MAX_LINES];
+   
+   /* poll engine: Wakeup eventfd is entry 0 followed by the lines */
+   struct pollfd PollFileDescr[EVT_ENGINE_MAX_LINES+1];
+
+#ifdef RPI_BTN_IO_URING_ENGINE
+   struct io_uring Ring;
+   bool    RingCreated;
+   uint64  WakeBuf;
+   char    LineBuf[EVT_ENGINE_MAX_LINES][4];
+   bool    ReadRequested[EVT_ENGINE_MAX_LINES];
+   bool    ReadInFlight[EVT_ENGINE_MAX_LINES];
+   bool    ReadDone[EVT_ENGINE_MAX_LINES];
+   uint16  ReadsInFlight;
+#endif
+
+   /*
+   ** Statistics
+   */
+   
+   uint32  WakeCnt;      /* Returns from EVT_ENGINE_Wait() */
+   uint32  SyscallCnt;
+   uint32  EdgeCnt;
+   uint32  MergedCnt;    /* Line notifications merged into one value read, each hides at least one edge */
+   uint32  OverrunCnt;   /* Edges dropped because the caller's edge buffer was full */
+   
+} EVT_ENGINE_Class_t;
+
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: EVT_ENGINE_Constructor
+**
+** Initialize an event engine object to a known state
+**
+** Notes:
+**   1. EngineStr is the ini file engine name. An io_uring request falls back
+**      to the poll engine when io_uring isn't built in or can't be created.
+**   2. EngineStr is ignored for a fixed profile build and there's no
+**      fallback if the RPI_BTN_FIXED_ENGINE can't be created.
+**
+*/
+bool EVT_ENGINE_Constructor(EVT_ENGINE_Class_t *EvtEngine, const char *EngineStr);
+
+
+/******************************************************************************
+** Function: EVT_ENGINE_AddLine
+**
+** Add a sysfs GPIO value file that has been configured for edge interrupts.
+**
+** Notes:
+**   1. Returns the line index used in EVT_ENGINE_Edge_t or -1 if the line
+**      can't be added.
+**
+*/
+int EVT_ENGINE_AddLine(EVT_ENGINE_Class_t *EvtEngine, int FileDescr);
+
+
+/******************************************************************************
+** Function: EVT_ENGINE_AddEventFile
+**
+** Add a file that becomes readable when events are queued.
+**
+** Notes:
+**   1. Returns the line index used in EVT_ENGINE_Edge_t or -1 if the file
+**      can't be added.
+**   2. The engine doesn't read the file. The owner must drain it after
+**      each reported edge or the io_uring engine won't report it again.
+**
+*/
+int EVT_ENGINE_AddEventFile(EVT_ENGINE_Class_t *EvtEngine, int FileDescr);
+
+
+/******************************************************************************
+** Function: EVT_ENGINE_ResetStatus
+**
+** Reset the statistics.
+**
+** Notes:
+**   1. Must be called by the task that calls EVT_ENGINE_Wait().
+**
+*/
+void EVT_ENGINE_ResetStatus(EVT_ENGINE_Class_t *EvtEngine);
+
+
+/******************************************************************************
+** Function: EVT_ENGINE_Wait
+**
+** Wait for edges on the lines or a wakeup request.
+**
+** Notes:
+**   1. Returns the number of edges written to Edges which may be zero for a
+**      timeout or wakeup. Returns -1 on an error.
+**   2. TimeoutMs < 0 waits indefinitely.
+**   3. MaxEdges must be at least the number of lines. At most one edge per
+**      line is reported per call, sysfs coalesces edges that occur before
+**      the value is read.
+**
+*/
+int EVT_ENGINE_Wait(EVT_ENGINE_Class_t *EvtEngine, EVT_ENGINE_Edge_t *Edges, 
+                    int MaxEdges, int TimeoutMs, bool *WakeRequested);
+
+
+/******************************************************************************
+** Function: EVT_ENGINE_Wake
+**
+** Wake the task blocked in EVT_ENGINE_Wait()
+**
+** Notes:
+**   1. May be called from any task.
+**
+*/
+void EVT_ENGINE_Wake(EVT_ENGINE_Class_t *EvtEngine);
+
+
+/******************************************************************************
+** Function: EVT_ENGINE_TypeStr
+**
+** Return the engine name used in the ini file
+**
+*/
+const char *EVT_ENGINE_TypeStr(EVT_ENGINE_Type_t Type);
+
+
+#endif /* _evt_engine_ */
@@ -0,0 +1,222 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the GPIO character device Class methods
+**
+**  Notes:
+**    1. The kernel event buffer is sized by RPI_BTN_CDEV_KERNEL_EVENTS so
+**       bursts are absorbed between child task wakeups.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/ioctl.h>
+
+#include "gpio_cdev.h"
+
+
+/******************************************************************************
+** Function: GPIO_CDEV_Constructor
+**
+*/
+bool GPIO_CDEV_Constructor(GPIO_CDEV_Class_t *GpioCdev, const char *ChipPath,
+                           const uint8 *Pin, uint8 LineCnt, uint8 Edge, const char *Consumer)
+{
+
+   struct gpio_v2_line_request Request;
+   int  ChipFileDescr;
+   bool RetStatus = false;
+   uint8 i;
+
+   memset(GpioCdev, 0, sizeof(GPIO_CDEV_Class_t));
+   GpioCdev->FileDescr = -1;
+   GpioCdev->NextSeqNo = 1;
+
+   if (LineCnt == 0 || LineCnt > GPIO_CDEV_MAX_LINES)
+   {
+      CFE_EVS_SendEvent(GPIO_CDEV_REQUEST_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid line count %d. Value must be in range [1..%d]", LineCnt, GPIO_CDEV_MAX_LINES);
+      return false;
+   }
+
+   memset(&Request, 0, sizeof(Request));
+   GpioCdev->LineCnt = LineCnt;
+   for (i=0; i < LineCnt; i++)
+   {
+      GpioCdev->Pin[i]   = Pin[i];
+      Request.offsets[i] = Pin[i];
+   }
+   strncpy(Request.consumer, Consumer, sizeof(Request.consumer)-1);
+   Request.num_lines = LineCnt;
+   Request.event_buffer_size = RPI_BTN_CDEV_KERNEL_EVENTS;
+   Request.config.flags = GPIO_V2_LINE_FLAG_INPUT;
+   if (Edge != RPI_BTN_EDGE_FALLING)
+   {
+      Request.config.flags |= GPIO_V2_LINE_FLAG_EDGE_RISING;
+   }
+   if (Edge != RPI_BTN_EDGE_RISING)
+   {
+      Request.config.flags |= GPIO_V2_LINE_FLAG_EDGE_FALLING;
+   }
+
+   ChipFileDescr = open(ChipPath, O_RDONLY | O_CLOEXEC);
+   if (ChipFileDescr >= 0)
+   {
+
+      if (ioctl(ChipFileDescr, GPIO_V2_GET_LINE_IOCTL, &Request) == 0)
+      {
+         GpioCdev->FileDescr = Request.fd;
+         fcntl(GpioCdev->FileDescr, F_SETFL, fcntl(GpioCdev->FileDescr, F_GETFL) | O_NONBLOCK);
+         RetStatus = true;
+      }
+      else
+      {
+         CFE_EVS_SendEvent(GPIO_CDEV_REQUEST_EID, CFE_EVS_EventType_ERROR,
+                           "Failed to request %d lines starting at pin %d from %s, errno %d",
+                           LineCnt, Pin[0], ChipPath, errno);
+      }
+      close(ChipFileDescr);
+
+   } /* End if chip opened */
+   else
+   {
+      CFE_EVS_SendEvent(GPIO_CDEV_REQUEST_EID, CFE_EVS_EventType_ERROR,
+                        "Failed to open GPIO chip %s, errno %d", ChipPath, errno);
+   }
+
+   return RetStatus;
+
+} /* End GPIO_CDEV_Constructor() */
+
+
+/******************************************************************************
+** Function: GPIO_CDEV_GetLevels
+**
+*/
+bool GPIO_CDEV_GetLevels(GPIO_CDEV_Class_t *GpioCdev, uint32 *Levels)
+{
+
+   struct gpio_v2_line_values Values;
+   bool RetStatus = false;
+
+   Values.bits = 0;
+   Values.mask = (1ULL << GpioCdev->LineCnt) - 1;
+
+   if (ioctl(GpioCdev->FileDescr, GPIO_V2_LINE_GET_VALUES_IOCTL, &Values) == 0)
+   {
+      *Levels = (uint32)Values.bits;
+      RetStatus = true;
+   }
+
+   return RetStatus;
+
+} /* End GPIO_CDEV_GetLevels() */
+
+
+/******************************************************************************
+** Function: GPIO_CDEV_LineIndex
+**
+*/
+int GPIO_CDEV_LineIndex(const GPIO_CDEV_Class_t *GpioCdev, uint32 Offset)
+{
+
+   int Line;
+
+   for (Line=GpioCdev->LineCnt-1; Line >= 0; Line--)
+   {
+      if (GpioCdev->Pin[Line] == Offset)
+      {
+         break;
+      }
+   }
+
+   return Line;
+
+} /* End GPIO_CDEV_LineIndex() */
+
+
+/******************************************************************************
+** Function: GPIO_CDEV_NowNs
+**
+*/
+uint64 GPIO_CDEV_NowNs(void)
+{
+
+   struct timespec Time;
+
+   clock_gettime(CLOCK_MONOTONIC, &Time);
+
+   return ((uint64)Time.tv_sec * 1000000000ULL) + (uint64)Time.tv_nsec;
+
+} /* End GPIO_CDEV_NowNs() */
+
+
+/******************************************************************************
+** Function: GPIO_CDEV_ReadEvents
+**
+*/
+int GPIO_CDEV_ReadEvents(GPIO_CDEV_Class_t *GpioCdev)
+{
+
+   ssize_t ReadLen;
+   int     EventCnt = 0;
+   int     i;
+
+   ReadLen = read(GpioCdev->FileDescr, GpioCdev->Event, sizeof(GpioCdev->Event));
+   GpioCdev->ReadCnt++;
+
+   if (ReadLen > 0)
+   {
+
+      EventCnt = ReadLen / sizeof(struct gpio_v2_line_event);
+      for (i=0; i < EventCnt; i++)
+      {
+         GpioCdev->LostCnt  += GpioCdev->Event[i].seqno - GpioCdev->NextSeqNo;
+         GpioCdev->NextSeqNo = GpioCdev->Event[i].seqno + 1;
+      }
+      GpioCdev->EventCnt += EventCnt;
+
+   }
+   else if (ReadLen < 0 && errno != EAGAIN && errno != EINTR)
+   {
+      EventCnt = -1;
+      CFE_EVS_SendEvent(GPIO_CDEV_READ_EID, CFE_EVS_EventType_ERROR,
+                        "Failed to read GPIO line events, errno %d", errno);
+   }
+
+   return EventCnt;
+
+} /* End GPIO_CDEV_ReadEvents() */
+
+
+/******************************************************************************
+** Function: GPIO_CDEV_ResetStatus
+**
+*/
+void GPIO_CDEV_ResetStatus(GPIO_CDEV_Class_t *GpioCdev)
+{
+
+   GpioCdev->EventCnt = 0;
+   GpioCdev->LostCnt  = 0;
+
+} /* End GPIO_CDEV_ResetStatus() */
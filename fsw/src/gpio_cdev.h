@@ -0,0 +1,173 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the GPIO character device class
+**
+**  Notes:
+**    1. Wraps a GPIO chip line request using the Linux GPIO v2 character
+**       device uAPI. Unlike sysfs the kernel queues every edge with a
+**       CLOCK_MONOTONIC timestamp and sequence numbers so edges aren't
+**       coalesced and many can be read with one read().
+**    2. The request's file descriptor is non-blocking and becomes readable
+**       (POLLIN) when edge events are queued. Add it to the event engine
+**       with EVT_ENGINE_AddEventFile().
+**    3. A pin must not be exported to sysfs while it's requested here.
+**
+*/
+
+#ifndef _gpio_cdev_
+#define _gpio_cdev_
+
+/*
+** Includes
+*/
+
+#include <linux/gpio.h>
+#include "app_cfg.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define GPIO_CDEV_MAX_LINES  4
+
+
+/*
+** Event Message IDs
+*/
+
+#define GPIO_CDEV_REQUEST_EID  (GPIO_CDEV_BASE_EID + 0)
+#define GPIO_CDEV_READ_EID     (GPIO_CDEV_BASE_EID + 1)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+/******************************************************************************
+** GPIO_CDEV_Class
+*/
+
+typedef struct
+{
+
+   /*
+   ** Class State Data
+   */
+
+   int     FileDescr;        /* Line request, -1 if the request failed */
+   uint8   LineCnt;
+   uint8   Pin[GPIO_CDEV_MAX_LINES];
+   uint32  NextSeqNo;        /* Expected sequence number of the next event */
+
+   struct gpio_v2_line_event  Event[RPI_BTN_CDEV_READ_BATCH];
+
+   /*
+   ** Statistics
+   */
+
+   uint32  EventCnt;
+   uint32  LostCnt;          /* Events the kernel dropped because its buffer was full */
+   uint32  ReadCnt;          /* read() calls */
+
+} GPIO_CDEV_Class_t;
+
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: GPIO_CDEV_Constructor
+**
+** Request input lines with edge detection from a GPIO chip.
+**
+** Notes:
+**   1. Edge is RPI_BTN_EDGE_BOTH, RPI_BTN_EDGE_RISING or RPI_BTN_EDGE_FALLING.
+**   2. Returns false and sends an error event if the lines can't be
+**      requested.
+**
+*/
+bool GPIO_CDEV_Constructor(GPIO_CDEV_Class_t *GpioCdev, const char *ChipPath,
+                           const uint8 *Pin, uint8 LineCnt, uint8 Edge, const char *Consumer);
+
+
+/******************************************************************************
+** Function: GPIO_CDEV_GetLevels
+**
+** Read the current level of each requested line.
+**
+** Notes:
+**   1. Bit n of Levels is the level of line n.
+**
+*/
+bool GPIO_CDEV_GetLevels(GPIO_CDEV_Class_t *GpioCdev, uint32 *Levels);
+
+
+/******************************************************************************
+** Function: GPIO_CDEV_LineIndex
+**
+** Return the line index of an event's offset or -1 if it isn't requested.
+**
+*/
+int GPIO_CDEV_LineIndex(const GPIO_CDEV_Class_t *GpioCdev, uint32 Offset);
+
+
+/******************************************************************************
+** Function: GPIO_CDEV_NowNs
+**
+** Return the current time on the event timestamp clock, CLOCK_MONOTONIC, in
+** nanoseconds.
+**
+** Notes:
+**   1. This is the app's only monotonic clock so times measured by the
+**      sysfs modes and the main task compare with the kernel timestamps.
+**
+*/
+uint64 GPIO_CDEV_NowNs(void);
+
+
+/******************************************************************************
+** Function: GPIO_CDEV_ReadEvents
+**
+** Read a batch of queued edge events into GpioCdev->Event[].
+**
+** Notes:
+**   1. Returns the number of events read, 0 if none are queued or -1 on an
+**      error. A full batch means more events may be queued, callers drain
+**      the queue by reading until a partial batch is returned.
+**   2. Sequence number gaps are added to LostCnt.
+**
+*/
+int GPIO_CDEV_ReadEvents(GPIO_CDEV_Class_t *GpioCdev);
+
+
+/******************************************************************************
+** Function: GPIO_CDEV_ResetStatus
+**
+** Reset the event and lost event counts.
+**
+** Notes:
+**   1. ReadCnt isn't reset, owners report read counts as the change since
+**      a previous value.
+**
+*/
+void GPIO_CDEV_ResetStatus(GPIO_CDEV_Class_t *GpioCdev);
+
+
+#endif /* _gpio_cdev_ */
@@ -0,0 +1,415 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the Keypad Class methods
+**
+**  Notes:
+**    1. Debouncing uses a two bit vertical counter per key. Each scan
+**       updates every key with a handful of 64-bit logic operations so the
+**       cost doesn't depend on the number of keys or how many are down.
+**    2. Rows that aren't being scanned are driven to the inactive level
+**       so a closed key on another row can't pull a column active.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "keypad.h"
+#include "button.h"
+#include "gpio_cdev.h"
+
+
+/*******************************/
+/** Local Function Prototypes **/
+/*******************************/
+
+static uint64 Debounce(KEYPAD_Class_t *Keypad, uint64 Raw);
+static uint8  ParsePinList(const char *PinListStr, uint8 *Pin, uint8 MaxPins);
+static uint32 ReadColumns(KEYPAD_Class_t *Keypad);
+static int    ReportKeys(KEYPAD_Class_t *Keypad, uint64 Changed);
+static uint64 ScanMatrix(KEYPAD_Class_t *Keypad);
+static void   SetAllRows(KEYPAD_Class_t *Keypad, bool Active);
+static bool   WriteRow(KEYPAD_Class_t *Keypad, uint8 Row, bool Active);
+
+
+/******************************************************************************
+** Function: KEYPAD_Constructor
+**
+*/
+bool KEYPAD_Constructor(KEYPAD_Class_t *Keypad, INITBL_Class_t *IniTbl)
+{
+
+   bool  PinsOpen = true;
+   uint8 i;
+
+   memset(Keypad, 0, sizeof(KEYPAD_Class_t));
+
+   Keypad->Cnt0 = ~(uint64)0;
+   Keypad->Cnt1 = ~(uint64)0;
+   Keypad->ActiveLevel  = (INITBL_GetIntConfig(IniTbl, CFG_KEYPAD_ACTIVE_LEVEL) == 0) ? 0 : 1;
+   PACER_Constructor(&Keypad->ScanPacer, (uint64)INITBL_GetIntConfig(IniTbl, CFG_KEYPAD_SCAN_MS) * 1000000);
+   Keypad->RowCnt = ParsePinList(INITBL_GetStrConfig(IniTbl, CFG_KEYPAD_ROW_PINS), Keypad->RowPin, RPI_BTN_KEYPAD_MAX_ROWS);
+   Keypad->ColCnt = ParsePinList(INITBL_GetStrConfig(IniTbl, CFG_KEYPAD_COL_PINS), Keypad->ColPin, RPI_BTN_KEYPAD_MAX_COLS);
+
+   CFE_MSG_Init(CFE_MSG_PTR(Keypad->KeyEventTlm.TelemetryHeader),
+                CFE_SB_ValueToMsgId(INITBL_GetIntConfig(IniTbl, CFG_RPI_BTN_KEY_EVENT_TLM_TOPICID)),
+                sizeof(RPI_BTN_KeyEventTlm_t));
+
+   if (Keypad->RowCnt == 0 || Keypad->ColCnt == 0)
+   {
+      CFE_EVS_SendEvent(KEYPAD_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid keypad pin lists, rows '%s' cols '%s'. Each needs 1 to %d/%d comma separated pins",
+                        INITBL_GetStrConfig(IniTbl, CFG_KEYPAD_ROW_PINS), INITBL_GetStrConfig(IniTbl, CFG_KEYPAD_COL_PINS),
+                        RPI_BTN_KEYPAD_MAX_ROWS, RPI_BTN_KEYPAD_MAX_COLS);
+   }
+   else if (Keypad->ScanPacer.PeriodNs == 0)
+   {
+      CFE_EVS_SendEvent(KEYPAD_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid keypad scan period, KEYPAD_SCAN_MS must be greater than 0");
+   }
+   else
+   {
+
+      for (i=0; i < Keypad->RowCnt; i++)
+      {
+         PinsOpen &= BUTTON_OpenGpio(Keypad->RowPin[i], BUTTON_GPIO_OUT, &Keypad->RowFileDescr[i]);
+      }
+      for (i=0; i < Keypad->ColCnt; i++)
+      {
+         PinsOpen &= BUTTON_OpenGpio(Keypad->ColPin[i], BUTTON_GPIO_IN, &Keypad->ColFileDescr[i]);
+      }
+
+      if (PinsOpen)
+      {
+         SetAllRows(Keypad, true);
+         PACER_Start(&Keypad->ScanPacer, GPIO_CDEV_NowNs());
+         Keypad->Connected = true;
+         CFE_EVS_SendEvent(KEYPAD_CONSTRUCTOR_EID, CFE_EVS_EventType_INFORMATION,
+                           "Sucessfully connected to a %dx%d keypad scanned every %dms with a %d scan debounce",
+                           Keypad->RowCnt, Keypad->ColCnt, INITBL_GetIntConfig(IniTbl, CFG_KEYPAD_SCAN_MS),
+                           KEYPAD_DEBOUNCE_SCANS);
+      }
+      else
+      {
+         CFE_EVS_SendEvent(KEYPAD_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                           "Failed to open the keypad row and column GPIO pins");
+      }
+
+   } /* End if valid config */
+
+   return Keypad->Connected;
+
+} /* End KEYPAD_Constructor() */
+
+
+/******************************************************************************
+** Function: KEYPAD_ResetStatus
+**
+*/
+void KEYPAD_ResetStatus(KEYPAD_Class_t *Keypad)
+{
+
+   Keypad->ScanCnt     = 0;
+   Keypad->IdleScanCnt = 0;
+   Keypad->KeyEventCnt = 0;
+
+} /* End KEYPAD_ResetStatus() */
+
+
+/******************************************************************************
+** Function: KEYPAD_Scan
+**
+*/
+int KEYPAD_Scan(KEYPAD_Class_t *Keypad)
+{
+
+   uint64 NowNs = GPIO_CDEV_NowNs();
+   uint64 Raw = 0;
+   uint64 Changed;
+   int    KeyEventCnt = 0;
+
+   if (Keypad->Connected && PACER_Due(&Keypad->ScanPacer, NowNs))
+   {
+
+      Keypad->ScanCnt++;
+      if (Keypad->RowsParked)
+      {
+         Keypad->IdleScanCnt++;
+         if (ReadColumns(Keypad) != 0)
+         {
+            SetAllRows(Keypad, false);
+            Raw = ScanMatrix(Keypad);
+         }
+      }
+      else
+      {
+         Raw = ScanMatrix(Keypad);
+      }
+
+      Keypad->Raw = Raw;
+      Changed = Debounce(Keypad, Raw);
+      if (Changed != 0)
+      {
+         KeyEventCnt = ReportKeys(Keypad, Changed);
+      }
+
+      /* Nothing down and nothing bouncing */
+      if (!Keypad->RowsParked && Raw == 0 && Keypad->Debounced == 0)
+      {
+         SetAllRows(Keypad, true);
+      }
+
+   } /* End if scan due */
+
+   return KeyEventCnt;
+
+} /* End KEYPAD_Scan() */
+
+
+/******************************************************************************
+** Function: KEYPAD_TimeoutMs
+**
+*/
+int KEYPAD_TimeoutMs(const KEYPAD_Class_t *Keypad)
+{
+
+   int TimeoutMs = -1;
+
+   if (Keypad->Connected)
+   {
+      TimeoutMs = PACER_TimeoutMs(&Keypad->ScanPacer, GPIO_CDEV_NowNs());
+   }
+
+   return TimeoutMs;
+
+} /* End KEYPAD_TimeoutMs() */
+
+
+/******************************************************************************
+**
+** Update the debounced key map with a raw scan
+**
+** Notes:
+**   1. A key's counter is reset while its raw state matches the debounced
+**      state and counts down while it differs. The debounced state toggles
+**      when the counter rolls over after KEYPAD_DEBOUNCE_SCANS scans.
+**   2. Returns the keys whose debounced state changed.
+**
+*/
+static uint64 Debounce(KEYPAD_Class_t *Keypad, uint64 Raw)
+{
+
+   uint64 Changed = Keypad->Debounced ^ Raw;
+
+   Keypad->Cnt0 = ~(Keypad->Cnt0 & Changed);
+   Keypad->Cnt1 = Keypad->Cnt0 ^ (Keypad->Cnt1 & Changed);
+   Changed &= Keypad->Cnt0 & Keypad->Cnt1;
+   Keypad->Debounced ^= Changed;
+
+   return Changed;
+
+} /* End Debounce() */
+
+
+/******************************************************************************
+**
+** Parse a comma separated GPIO pin list
+**
+** Notes:
+**   1. Returns the number of pins or 0 if the list is empty, has more than
+**      MaxPins entries or has an invalid entry.
+**
+*/
+static uint8 ParsePinList(const char *PinListStr, uint8 *Pin, uint8 MaxPins)
+{
+
+   const char *StrPtr = PinListStr;
+   char  *EndPtr;
+   long  PinValue;
+   uint8 PinCnt = 0;
+   bool  ValidList = true;
+
+   while (ValidList && *StrPtr != '\0')
+   {
+
+      PinValue = strtol(StrPtr, &EndPtr, 10);
+
+      if (EndPtr == StrPtr || PinValue < 0 || PinValue > 31 || PinCnt >= MaxPins)
+      {
+         ValidList = false;
+      }
+      else
+      {
+         Pin[PinCnt++] = (uint8)PinValue;
+         StrPtr = EndPtr;
+         while (*StrPtr == ',' || *StrPtr == ' ')
+         {
+            StrPtr++;
+         }
+      }
+
+   } /* End while */
+
+   return ValidList ? PinCnt : 0;
+
+} /* End ParsePinList() */
+
+
+/******************************************************************************
+**
+** Read the column inputs
+**
+** Notes:
+**   1. Returns a bit map of the active columns, bit 0 is the first column.
+**   2. A column that can't be read is reported as inactive.
+**
+*/
+static uint32 ReadColumns(KEYPAD_Class_t *Keypad)
+{
+
+   char   ValueStr[3];
+   uint32 Columns = 0;
+   uint8  Col;
+
+   for (Col=0; Col < Keypad->ColCnt; Col++)
+   {
+      if (pread(Keypad->ColFileDescr[Col], ValueStr, sizeof(ValueStr), 0) > 0)
+      {
+         if ((ValueStr[0] & 1) == Keypad->ActiveLevel)
+         {
+            Columns |= (1 << Col);
+         }
+      }
+   }
+
+   return Columns;
+
+} /* End ReadColumns() */
+
+
+/******************************************************************************
+**
+** Send a key event telemetry packet and an event message for each key whose
+** debounced state changed
+**
+*/
+static int ReportKeys(KEYPAD_Class_t *Keypad, uint64 Changed)
+{
+
+   RPI_BTN_KeyEventTlm_Payload_t *Payload = &Keypad->KeyEventTlm.Payload;
+   uint8 Key;
+   int   KeyEventCnt = 0;
+
+   for (Key=0; Changed != 0; Key++, Changed >>= 1)
+   {
+
+      if (Changed & 1)
+      {
+
+         Payload->Key      = Key;
+         Payload->Row      = Key / Keypad->ColCnt;
+         Payload->Col      = Key % Keypad->ColCnt;
+         Payload->Down     = (Keypad->Debounced >> Key) & 1;
+         Payload->KeysDown = __builtin_popcountll(Keypad->Debounced);
+         Payload->KeyMap   = Keypad->Debounced;
+
+         CFE_SB_TimeStampMsg(CFE_MSG_PTR(Keypad->KeyEventTlm.TelemetryHeader));
+         CFE_SB_TransmitMsg(CFE_MSG_PTR(Keypad->KeyEventTlm.TelemetryHeader), true);
+
+         CFE_EVS_SendEvent(KEYPAD_KEY_EID, CFE_EVS_EventType_INFORMATION,
+                           "Key %d (row %d, col %d) %s, %d keys down", Payload->Key, Payload->Row,
+                           Payload->Col, Payload->Down ? "down" : "up", Payload->KeysDown);
+
+         Keypad->KeyEventCnt++;
+         KeyEventCnt++;
+
+      } /* End if key changed */
+
+   } /* End key loop */
+
+   return KeyEventCnt;
+
+} /* End ReportKeys() */
+
+
+/******************************************************************************
+**
+** Scan each row and return the raw key map
+**
+** Notes:
+**   1. All rows must be inactive on entry and are inactive on exit.
+**
+*/
+static uint64 ScanMatrix(KEYPAD_Class_t *Keypad)
+{
+
+   uint64 Raw = 0;
+   uint8  Row;
+
+   for (Row=0; Row < Keypad->RowCnt; Row++)
+   {
+      WriteRow(Keypad, Row, true);
+      Raw |= (uint64)ReadColumns(Keypad) << (Row * Keypad->ColCnt);
+      WriteRow(Keypad, Row, false);
+   }
+
+   return Raw;
+
+} /* End ScanMatrix() */
+
+
+/******************************************************************************
+**
+** Drive all of the rows active to park the keypad or inactive to scan it
+**
+** Notes:
+**   1. While parked any key press makes its column active so an idle scan
+**      only needs to read the columns.
+**
+*/
+static void SetAllRows(KEYPAD_Class_t *Keypad, bool Active)
+{
+
+   uint8 Row;
+
+   for (Row=0; Row < Keypad->RowCnt; Row++)
+   {
+      WriteRow(Keypad, Row, Active);
+   }
+
+   Keypad->RowsParked = Active;
+
+} /* End SetAllRows() */
+
+
+/******************************************************************************
+**
+** Drive a row output
+**
+*/
+static bool WriteRow(KEYPAD_Class_t *Keypad, uint8 Row, bool Active)
+{
+
+   int Level = Active ? Keypad->ActiveLevel : !Keypad->ActiveLevel;
+
+   return (pwrite(Keypad->RowFileDescr[Row], (Level == 0) ? "0" : "1", 1, 0) == 1);
+
+} /* End WriteRow() */
@@ -0,0 +1,167 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the Keypad class
+**
+**  Notes:
+**    1. The keypad scans a key matrix by driving one row output active at a
+**       time and reading the column inputs. Keys are numbered
+**       Row*ColCnt + Col and each key is one bit in the packed key maps.
+**    2. The keypad is owned by the Button object and scanned by the Button
+**       child task when BTN_MODE is "keypad".
+**    3. The columns must have external pull resistors to the inactive level
+**       because sysfs can't configure the pin bias. N-key rollover requires
+**       a diode in series with each key, without diodes three keys pressed
+**       on the corners of a rectangle report a ghost key on the fourth.
+**
+*/
+
+#ifndef _keypad_
+#define _keypad_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+#include "pacer.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#if (RPI_BTN_KEYPAD_MAX_ROWS * RPI_BTN_KEYPAD_MAX_COLS) > 64
+   #error RPI_BTN_KEYPAD_MAX_ROWS * RPI_BTN_KEYPAD_MAX_COLS must fit in a 64-bit key map
+#endif
+
+/* Consecutive differing scans required to change a key's debounced state, fixed by the 2-bit counter */
+#define KEYPAD_DEBOUNCE_SCANS  4
+
+
+/*
+** Event Message IDs
+*/
+
+#define KEYPAD_CONSTRUCTOR_EID  (KEYPAD_BASE_EID + 0)
+#define KEYPAD_KEY_EID          (KEYPAD_BASE_EID + 1)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+/******************************************************************************
+** KEYPAD_Class
+*/
+
+typedef struct
+{
+
+   /*
+   ** Class State Data
+   */
+
+   bool    Connected;
+   uint8   RowCnt;
+   uint8   ColCnt;
+   uint8   RowPin[RPI_BTN_KEYPAD_MAX_ROWS];
+   uint8   ColPin[RPI_BTN_KEYPAD_MAX_COLS];
+   int     RowFileDescr[RPI_BTN_KEYPAD_MAX_ROWS];
+   int     ColFileDescr[RPI_BTN_KEYPAD_MAX_COLS];
+   int     ActiveLevel;       /* Level of a driven row and of a column with a closed key */
+   bool    RowsParked;        /* All rows driven active while the keypad is idle */
+
+   PACER_Class_t ScanPacer;
+
+   /*
+   ** Packed key maps. Cnt0 and Cnt1 are the two bit planes of a per-key
+   ** vertical counter that counts consecutive scans that differ from the
+   ** debounced state.
+   */
+
+   uint64  Raw;
+   uint64  Debounced;
+   uint64  Cnt0;
+   uint64  Cnt1;
+
+   /*
+   ** Statistics
+   */
+
+   uint32  ScanCnt;
+   uint32  IdleScanCnt;       /* Scans that only read the columns */
+   uint32  KeyEventCnt;
+
+   RPI_BTN_KeyEventTlm_t  KeyEventTlm;
+
+} KEYPAD_Class_t;
+
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: KEYPAD_Constructor
+**
+** Initialize a keypad object to a known state and open the row and column
+** GPIO pins.
+**
+** Notes:
+**   1. Returns true if all of the pins were opened. Error events describe
+**      any configuration errors.
+**
+*/
+bool KEYPAD_Constructor(KEYPAD_Class_t *Keypad, INITBL_Class_t *IniTbl);
+
+
+/******************************************************************************
+** Function: KEYPAD_ResetStatus
+**
+** Reset the scan and key event counts.
+**
+*/
+void KEYPAD_ResetStatus(KEYPAD_Class_t *Keypad);
+
+
+/******************************************************************************
+** Function: KEYPAD_Scan
+**
+** Scan the matrix if a scan is due and report debounced key changes.
+**
+** Notes:
+**   1. Called by the child task each time it wakes. Returns the number of
+**      key-down and key-up events reported.
+**   2. While no key is down or bouncing the rows are left active and a
+**      scan only reads the columns. A full row-by-row scan is only done
+**      when a column is active.
+**
+*/
+int KEYPAD_Scan(KEYPAD_Class_t *Keypad);
+
+
+/******************************************************************************
+** Function: KEYPAD_TimeoutMs
+**
+** Return the time in milliseconds until the next scan is due.
+**
+*/
+int KEYPAD_TimeoutMs(const KEYPAD_Class_t *Keypad);
+
+
+#endif /* _keypad_ */
@@ -0,0 +1,101 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the periodic activity pacer class methods
+**
+**  Notes:
+**    1. See pacer.h prologue for the pacing rule.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+
+#include "pacer.h"
+
+
+/******************************************************************************
+** Function: PACER_Constructor
+**
+*/
+void PACER_Constructor(PACER_Class_t *Pacer, uint64 PeriodNs)
+{
+
+   memset(Pacer, 0, sizeof(PACER_Class_t));
+
+   Pacer->PeriodNs = PeriodNs;
+   Pacer->NextNs   = ~(uint64)0;
+
+} /* End PACER_Constructor() */
+
+
+/******************************************************************************
+** Function: PACER_Due
+**
+*/
+bool PACER_Due(PACER_Class_t *Pacer, uint64 NowNs)
+{
+
+   bool Due = false;
+
+   if (NowNs >= Pacer->NextNs)
+   {
+
+      Pacer->NextNs += Pacer->PeriodNs;
+      if (Pacer->NextNs <= NowNs)
+      {
+         Pacer->NextNs = NowNs + Pacer->PeriodNs;
+      }
+      Due = true;
+
+   }
+
+   return Due;
+
+} /* End PACER_Due() */
+
+
+/******************************************************************************
+** Function: PACER_Start
+**
+*/
+void PACER_Start(PACER_Class_t *Pacer, uint64 NowNs)
+{
+
+   Pacer->NextNs = NowNs + Pacer->PeriodNs;
+
+} /* End PACER_Start() */
+
+
+/******************************************************************************
+** Function: PACER_TimeoutMs
+**
+*/
+int PACER_TimeoutMs(const PACER_Class_t *Pacer, uint64 NowNs)
+{
+
+   int TimeoutMs = 0;
+
+   if (Pacer->NextNs > NowNs)
+   {
+      TimeoutMs = (int)((Pacer->NextNs - NowNs + 999999) / 1000000);
+   }
+
+   return TimeoutMs;
+
+} /* End PACER_TimeoutMs() */
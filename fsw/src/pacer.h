@@ -0,0 +1,109 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the periodic activity pacer class
+**
+**  Notes:
+**    1. Paces an activity serviced by the Button child task, such as a
+**       mode's telemetry update or the keypad scan, at a fixed cadence.
+**       Times are CLOCK_MONOTONIC nanoseconds.
+**    2. Each due time is one period after the previous due time so the
+**       cadence doesn't drift with the child task's wake latency. If the
+**       child task falls behind by a full period the cadence is restarted
+**       from the current time rather than running back-to-back catch ups.
+**
+*/
+
+#ifndef _pacer_
+#define _pacer_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+/******************************************************************************
+** PACER_Class
+*/
+
+typedef struct
+{
+
+   /*
+   ** Class State Data
+   */
+
+   uint64  PeriodNs;
+   uint64  NextNs;          /* Time the next period is due */
+
+} PACER_Class_t;
+
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: PACER_Constructor
+**
+** Initialize a pacer object to a known state.
+**
+** Notes:
+**   1. The pacer isn't due until PACER_Start() is called.
+**
+*/
+void PACER_Constructor(PACER_Class_t *Pacer, uint64 PeriodNs);
+
+
+/******************************************************************************
+** Function: PACER_Due
+**
+** Return true if a period is due at NowNs and advance to the next period.
+**
+*/
+bool PACER_Due(PACER_Class_t *Pacer, uint64 NowNs);
+
+
+/******************************************************************************
+** Function: PACER_Start
+**
+** Start the cadence so the first period is due one period after NowNs.
+**
+*/
+void PACER_Start(PACER_Class_t *Pacer, uint64 NowNs);
+
+
+/******************************************************************************
+** Function: PACER_TimeoutMs
+**
+** Return the milliseconds until the next period is due.
+**
+** Notes:
+**   1. Rounded up so the child task never wakes before a period is due. 0
+**      is returned if a period is already due.
+**
+*/
+int PACER_TimeoutMs(const PACER_Class_t *Pacer, uint64 NowNs);
+
+
+#endif /* _pacer_ */
@@ -0,0 +1,203 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the Pulse Class methods
+**
+**  Notes:
+**    1. Only rising edges are requested so every kernel event sequence
+**       number is one pulse. Pulses are counted from the sequence numbers
+**       rather than the events read so pulses the kernel drops when its
+**       queue overflows are still counted, they're also reported in LostCnt.
+**    2. Only the last event of each batch is used so the cost per pulse is
+**       the kernel's cost of queuing and copying the event.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+
+#include "pulse.h"
+
+
+/******************************************************************************
+** Function: PULSE_Constructor
+**
+*/
+bool PULSE_Constructor(PULSE_Class_t *Pulse, INITBL_Class_t *IniTbl)
+{
+
+   uint8 Pin = INITBL_GetIntConfig(IniTbl, CFG_PULSE_PIN);
+
+   memset(Pulse, 0, sizeof(PULSE_Class_t));
+
+   PACER_Constructor(&Pulse->TlmPacer, (uint64)INITBL_GetIntConfig(IniTbl, CFG_PULSE_TLM_MS) * 1000000);
+
+   CFE_MSG_Init(CFE_MSG_PTR(Pulse->Tlm.TelemetryHeader),
+                CFE_SB_ValueToMsgId(INITBL_GetIntConfig(IniTbl, CFG_RPI_BTN_PULSE_TLM_TOPICID)),
+                sizeof(RPI_BTN_PulseTlm_t));
+
+   if (Pulse->TlmPacer.PeriodNs == 0)
+   {
+      CFE_EVS_SendEvent(PULSE_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid pulse telemetry period, PULSE_TLM_MS must be greater than 0");
+   }
+   else if (GPIO_CDEV_Constructor(&Pulse->GpioCdev, INITBL_GetStrConfig(IniTbl, CFG_GPIO_CDEV_CHIP),
+                                  &Pin, 1, RPI_BTN_EDGE_RISING, "rpi_btn pulse"))
+   {
+
+      Pulse->GateStartNs = GPIO_CDEV_NowNs();
+      Pulse->Connected   = true;
+      PACER_Start(&Pulse->TlmPacer, Pulse->GateStartNs);
+
+      CFE_EVS_SendEvent(PULSE_CONSTRUCTOR_EID, CFE_EVS_EventType_INFORMATION,
+                        "Sucessfully connected to a pulse input on GPIO pin %d, telemetry every %dms",
+                        Pin, INITBL_GetIntConfig(IniTbl, CFG_PULSE_TLM_MS));
+
+   } /* End if line requested */
+
+   return Pulse->Connected;
+
+} /* End PULSE_Constructor() */
+
+
+/******************************************************************************
+** Function: PULSE_ProcessEvents
+**
+** Notes:
+**   1. Reads continue until a partial batch so the kernel queue is empty
+**      when this returns.
+**   2. The unsigned sequence number difference handles the 32-bit kernel
+**      sequence number wrapping.
+**
+*/
+int PULSE_ProcessEvents(PULSE_Class_t *Pulse)
+{
+
+   struct gpio_v2_line_event *Event;
+   int EventCnt;
+   int TotalEventCnt = 0;
+
+   do
+   {
+
+      EventCnt = GPIO_CDEV_ReadEvents(&Pulse->GpioCdev);
+
+      if (EventCnt > 0)
+      {
+         Event = &Pulse->GpioCdev.Event[EventCnt-1];
+         Pulse->PulseCnt  += (uint32)(Event->seqno - Pulse->LastSeqNo);
+         Pulse->LastSeqNo  = Event->seqno;
+         Pulse->LastEdgeNs = Event->timestamp_ns;
+         TotalEventCnt    += EventCnt;
+      }
+
+   } while (EventCnt == RPI_BTN_CDEV_READ_BATCH);
+
+   return (EventCnt < 0) ? -1 : TotalEventCnt;
+
+} /* End PULSE_ProcessEvents() */
+
+
+/******************************************************************************
+** Function: PULSE_ResetStatus
+**
+*/
+void PULSE_ResetStatus(PULSE_Class_t *Pulse)
+{
+
+   GPIO_CDEV_ResetStatus(&Pulse->GpioCdev);
+
+} /* End PULSE_ResetStatus() */
+
+
+/******************************************************************************
+** Function: PULSE_SendTlm
+**
+** Notes:
+**   1. The period frequency uses the last edge before this update and the
+**      last edge before the previous update. If there's no new edge it
+**      decays, bounded by one pulse over the time since the last edge.
+**
+*/
+void PULSE_SendTlm(PULSE_Class_t *Pulse)
+{
+
+   RPI_BTN_PulseTlm_Payload_t *Payload = &Pulse->Tlm.Payload;
+   uint64 NowNs = GPIO_CDEV_NowNs();
+   double MaxFreqHz;
+
+   if (Pulse->Connected && PACER_Due(&Pulse->TlmPacer, NowNs))
+   {
+
+      if (Pulse->PulseCnt > Pulse->RefPulseCnt)
+      {
+         if (Pulse->RefEdgeValid && Pulse->LastEdgeNs > Pulse->RefEdgeNs)
+         {
+            Pulse->PeriodFreqHz = (double)(Pulse->PulseCnt - Pulse->RefPulseCnt) * 1.0e9 /
+                                  (double)(Pulse->LastEdgeNs - Pulse->RefEdgeNs);
+         }
+         Pulse->RefEdgeValid = true;
+         Pulse->RefEdgeNs    = Pulse->LastEdgeNs;
+         Pulse->RefPulseCnt  = Pulse->PulseCnt;
+      }
+      else if (Pulse->RefEdgeValid && NowNs > Pulse->LastEdgeNs)
+      {
+         MaxFreqHz = 1.0e9 / (double)(NowNs - Pulse->LastEdgeNs);
+         if (Pulse->PeriodFreqHz > MaxFreqHz)
+         {
+            Pulse->PeriodFreqHz = MaxFreqHz;
+         }
+      }
+
+      Payload->PulseCount   = Pulse->PulseCnt;
+      Payload->GatePulses   = (uint32)(Pulse->PulseCnt - Pulse->GatePulseCnt);
+      Payload->GateMs       = (uint32)((NowNs - Pulse->GateStartNs) / 1000000);
+      Payload->GateFreqHz   = (float)((double)Payload->GatePulses * 1.0e9 / (double)(NowNs - Pulse->GateStartNs));
+      Payload->PeriodFreqHz = (float)Pulse->PeriodFreqHz;
+      Payload->Reads        = Pulse->GpioCdev.ReadCnt - Pulse->GateReadCnt;
+      Payload->LostCnt      = Pulse->GpioCdev.LostCnt;
+
+      CFE_SB_TimeStampMsg(CFE_MSG_PTR(Pulse->Tlm.TelemetryHeader));
+      CFE_SB_TransmitMsg(CFE_MSG_PTR(Pulse->Tlm.TelemetryHeader), true);
+
+      Pulse->GateStartNs  = NowNs;
+      Pulse->GatePulseCnt = Pulse->PulseCnt;
+      Pulse->GateReadCnt  = Pulse->GpioCdev.ReadCnt;
+
+   } /* End if update due */
+
+} /* End PULSE_SendTlm() */
+
+
+/******************************************************************************
+** Function: PULSE_TimeoutMs
+**
+*/
+int PULSE_TimeoutMs(const PULSE_Class_t *Pulse)
+{
+
+   int TimeoutMs = -1;
+
+   if (Pulse->Connected)
+   {
+      TimeoutMs = PACER_TimeoutMs(&Pulse->TlmPacer, GPIO_CDEV_NowNs());
+   }
+
+   return TimeoutMs;
+
+} /* End PULSE_TimeoutMs() */
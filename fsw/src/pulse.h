@@ -0,0 +1,152 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the Pulse class
+**
+**  Notes:
+**    1. Counts rising edges of a pulse train on a GPIO character device
+**       line and measures its frequency two ways each telemetry period:
+**       - Gated:  Pulses in the period divided by the period. Resolution
+**                 is one pulse per period so it suits high frequencies.
+**       - Period: Pulses between the first and last edge timestamps used
+**                 divided by the time between them. Resolution is the
+**                 timestamp resolution so it suits low frequencies.
+**    2. The pulse is owned by the Button object and serviced by the Button
+**       child task when BTN_MODE is "pulse".
+**
+*/
+
+#ifndef _pulse_
+#define _pulse_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+#include "gpio_cdev.h"
+#include "pacer.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+
+/*
+** Event Message IDs
+*/
+
+#define PULSE_CONSTRUCTOR_EID  (PULSE_BASE_EID + 0)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+/******************************************************************************
+** PULSE_Class
+*/
+
+typedef struct
+{
+
+   /*
+   ** Class State Data
+   */
+
+   bool    Connected;
+   GPIO_CDEV_Class_t GpioCdev;
+
+   uint64  PulseCnt;            /* Includes pulses the kernel dropped, see pulse.c */
+   uint32  LastSeqNo;
+   uint64  LastEdgeNs;
+
+   bool    RefEdgeValid;
+   uint64  RefEdgeNs;           /* Last edge at the previous telemetry update */
+   uint64  RefPulseCnt;
+   double  PeriodFreqHz;
+
+   PACER_Class_t TlmPacer;
+   uint64  GateStartNs;
+   uint64  GatePulseCnt;        /* PulseCnt at the start of the gate */
+   uint32  GateReadCnt;         /* GpioCdev.ReadCnt at the start of the gate */
+
+   RPI_BTN_PulseTlm_t Tlm;
+
+} PULSE_Class_t;
+
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: PULSE_Constructor
+**
+** Initialize a pulse object to a known state and request its line.
+**
+** Notes:
+**   1. Returns true if the line was requested.
+**
+*/
+bool PULSE_Constructor(PULSE_Class_t *Pulse, INITBL_Class_t *IniTbl);
+
+
+/******************************************************************************
+** Function: PULSE_ProcessEvents
+**
+** Drain the queued edge events and update the pulse count.
+**
+** Notes:
+**   1. Returns the number of events read or -1 if a read failed.
+**
+*/
+int PULSE_ProcessEvents(PULSE_Class_t *Pulse);
+
+
+/******************************************************************************
+** Function: PULSE_ResetStatus
+**
+** Reset the lost event count.
+**
+** Notes:
+**   1. PulseCount is a measurement and isn't reset.
+**
+*/
+void PULSE_ResetStatus(PULSE_Class_t *Pulse);
+
+
+/******************************************************************************
+** Function: PULSE_SendTlm
+**
+** Compute the frequencies and send PulseTlm if an update is due.
+**
+*/
+void PULSE_SendTlm(PULSE_Class_t *Pulse);
+
+
+/******************************************************************************
+** Function: PULSE_TimeoutMs
+**
+** Return the time in milliseconds until the next telemetry update is due.
+**
+*/
+int PULSE_TimeoutMs(const PULSE_Class_t *Pulse);
+
+
+#endif /* _pulse_ */
@@ -0,0 +1,332 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the PWM measurement Class methods
+**
+**  Notes:
+**    1. A period is only measured from a rising, falling, rising edge
+**       sequence with consecutive kernel sequence numbers. A dropped event
+**       or a repeated edge type restarts the pairing so a missing edge
+**       never merges two periods into one.
+**    2. The mean duty cycle is the total high time over the total period
+**       so it's weighted by period length.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+
+#include "pwm.h"
+
+
+/*******************************/
+/** Local Function Prototypes **/
+/*******************************/
+
+static void AddPeriod(PWM_Class_t *Pwm, uint64 PeriodNs, uint64 HighNs);
+static void AddSample(PWM_Stats_t *Stats, uint64 Sample);
+static void ResetWindow(PWM_Class_t *Pwm, uint64 NowNs);
+
+
+/******************************************************************************
+** Function: PWM_Constructor
+**
+*/
+bool PWM_Constructor(PWM_Class_t *Pwm, INITBL_Class_t *IniTbl)
+{
+
+   uint8 Pin = INITBL_GetIntConfig(IniTbl, CFG_PWM_PIN);
+
+   memset(Pwm, 0, sizeof(PWM_Class_t));
+
+   PACER_Constructor(&Pwm->WindowPacer, (uint64)INITBL_GetIntConfig(IniTbl, CFG_PWM_WINDOW_MS) * 1000000);
+
+   CFE_MSG_Init(CFE_MSG_PTR(Pwm->Tlm.TelemetryHeader),
+                CFE_SB_ValueToMsgId(INITBL_GetIntConfig(IniTbl, CFG_RPI_BTN_PWM_TLM_TOPICID)),
+                sizeof(RPI_BTN_PwmTlm_t));
+
+   if (Pwm->WindowPacer.PeriodNs == 0)
+   {
+      CFE_EVS_SendEvent(PWM_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid PWM measurement window, PWM_WINDOW_MS must be greater than 0");
+   }
+   else if (GPIO_CDEV_Constructor(&Pwm->GpioCdev, INITBL_GetStrConfig(IniTbl, CFG_GPIO_CDEV_CHIP),
+                                  &Pin, 1, RPI_BTN_EDGE_BOTH, "rpi_btn pwm"))
+   {
+
+      ResetWindow(Pwm, GPIO_CDEV_NowNs());
+      PACER_Start(&Pwm->WindowPacer, Pwm->WindowStartNs);
+      Pwm->Connected = true;
+
+      CFE_EVS_SendEvent(PWM_CONSTRUCTOR_EID, CFE_EVS_EventType_INFORMATION,
+                        "Sucessfully connected to a PWM input on GPIO pin %d, measurement window %dms",
+                        Pin, INITBL_GetIntConfig(IniTbl, CFG_PWM_WINDOW_MS));
+
+   } /* End if line requested */
+
+   return Pwm->Connected;
+
+} /* End PWM_Constructor() */
+
+
+/******************************************************************************
+** Function: PWM_ProcessEvents
+**
+** Notes:
+**   1. Reads continue until a partial batch so the kernel queue is empty
+**      when this returns.
+**
+*/
+int PWM_ProcessEvents(PWM_Class_t *Pwm)
+{
+
+   GPIO_CDEV_Class_t *GpioCdev = &Pwm->GpioCdev;
+   struct gpio_v2_line_event *Event;
+   int EventCnt;
+   int TotalEventCnt = 0;
+   int i;
+
+   do
+   {
+
+      EventCnt = GPIO_CDEV_ReadEvents(GpioCdev);
+
+      for (i=0; i < EventCnt; i++)
+      {
+
+         Event = &GpioCdev->Event[i];
+
+         if (Event->seqno != Pwm->LastSeqNo + 1)
+         {
+            Pwm->RisingValid = false;
+         }
+         Pwm->LastSeqNo = Event->seqno;
+
+         if (Event->id == GPIO_V2_LINE_EVENT_RISING_EDGE)
+         {
+            if (Pwm->RisingValid)
+            {
+               if (Pwm->FallingValid)
+               {
+                  AddPeriod(Pwm, Event->timestamp_ns - Pwm->RisingNs, Pwm->FallingNs - Pwm->RisingNs);
+               }
+               else
+               {
+                  Pwm->InvalidCnt++;
+               }
+            }
+            Pwm->RisingValid  = true;
+            Pwm->RisingNs     = Event->timestamp_ns;
+            Pwm->FallingValid = false;
+         }
+         else if (Pwm->RisingValid)
+         {
+            if (Pwm->FallingValid)
+            {
+               Pwm->RisingValid = false;
+               Pwm->InvalidCnt++;
+            }
+            else
+            {
+               Pwm->FallingValid = true;
+               Pwm->FallingNs    = Event->timestamp_ns;
+            }
+         }
+
+      } /* End event loop */
+
+      if (EventCnt > 0)
+      {
+         TotalEventCnt += EventCnt;
+      }
+
+   } while (EventCnt == RPI_BTN_CDEV_READ_BATCH);
+
+   return (EventCnt < 0) ? -1 : TotalEventCnt;
+
+} /* End PWM_ProcessEvents() */
+
+
+/******************************************************************************
+** Function: PWM_ResetStatus
+**
+*/
+void PWM_ResetStatus(PWM_Class_t *Pwm)
+{
+
+   Pwm->InvalidCnt = 0;
+   GPIO_CDEV_ResetStatus(&Pwm->GpioCdev);
+
+} /* End PWM_ResetStatus() */
+
+
+/******************************************************************************
+** Function: PWM_SendTlm
+**
+** Notes:
+**   1. If no period was measured in the window the signal is held at one
+**      level so the duty cycle is 0% or 100% from the current line level.
+**
+*/
+void PWM_SendTlm(PWM_Class_t *Pwm)
+{
+
+   RPI_BTN_PwmTlm_Payload_t *Payload = &Pwm->Tlm.Payload;
+   uint64 NowNs = GPIO_CDEV_NowNs();
+   uint32 Levels = 0;
+
+   if (Pwm->Connected && PACER_Due(&Pwm->WindowPacer, NowNs))
+   {
+
+      GPIO_CDEV_GetLevels(&Pwm->GpioCdev, &Levels);
+
+      Payload->WindowMs   = (uint32)((NowNs - Pwm->WindowStartNs) / 1000000);
+      Payload->Periods    = Pwm->PeriodCnt;
+      Payload->InvalidCnt = Pwm->InvalidCnt;
+      Payload->LostCnt    = Pwm->GpioCdev.LostCnt;
+      Payload->Level      = (uint8)(Levels & 1);
+
+      if (Pwm->PeriodCnt > 0)
+      {
+         Payload->PeriodMinUs  = (float)Pwm->PeriodNs.Min / 1000.0f;
+         Payload->PeriodMaxUs  = (float)Pwm->PeriodNs.Max / 1000.0f;
+         Payload->PeriodMeanUs = (float)((double)Pwm->PeriodNs.Sum / Pwm->PeriodCnt / 1000.0);
+         Payload->HighMinUs    = (float)Pwm->HighNs.Min / 1000.0f;
+         Payload->HighMaxUs    = (float)Pwm->HighNs.Max / 1000.0f;
+         Payload->HighMeanUs   = (float)((double)Pwm->HighNs.Sum / Pwm->PeriodCnt / 1000.0);
+         Payload->DutyMinPct   = (float)(Pwm->DutyMin * 100.0);
+         Payload->DutyMaxPct   = (float)(Pwm->DutyMax * 100.0);
+         Payload->DutyMeanPct  = (float)((double)Pwm->HighNs.Sum * 100.0 / (double)Pwm->PeriodNs.Sum);
+      }
+      else
+      {
+         Payload->PeriodMinUs  = 0.0f;
+         Payload->PeriodMaxUs  = 0.0f;
+         Payload->PeriodMeanUs = 0.0f;
+         Payload->HighMinUs    = 0.0f;
+         Payload->HighMaxUs    = 0.0f;
+         Payload->HighMeanUs   = 0.0f;
+         Payload->DutyMinPct   = Payload->Level ? 100.0f : 0.0f;
+         Payload->DutyMaxPct   = Payload->DutyMinPct;
+         Payload->DutyMeanPct  = Payload->DutyMinPct;
+      }
+
+      CFE_SB_TimeStampMsg(CFE_MSG_PTR(Pwm->Tlm.TelemetryHeader));
+      CFE_SB_TransmitMsg(CFE_MSG_PTR(Pwm->Tlm.TelemetryHeader), true);
+
+      ResetWindow(Pwm, NowNs);
+
+   } /* End if window ended */
+
+} /* End PWM_SendTlm() */
+
+
+/******************************************************************************
+** Function: PWM_TimeoutMs
+**
+*/
+int PWM_TimeoutMs(const PWM_Class_t *Pwm)
+{
+
+   int TimeoutMs = -1;
+
+   if (Pwm->Connected)
+   {
+      TimeoutMs = PACER_TimeoutMs(&Pwm->WindowPacer, GPIO_CDEV_NowNs());
+   }
+
+   return TimeoutMs;
+
+} /* End PWM_TimeoutMs() */
+
+
+/******************************************************************************
+** Function: AddPeriod
+**
+*/
+static void AddPeriod(PWM_Class_t *Pwm, uint64 PeriodNs, uint64 HighNs)
+{
+
+   double Duty;
+
+   if (PeriodNs > 0)
+   {
+
+      Duty = (double)HighNs / (double)PeriodNs;
+
+      if (Pwm->PeriodCnt == 0 || Duty < Pwm->DutyMin)
+      {
+         Pwm->DutyMin = Duty;
+      }
+      if (Pwm->PeriodCnt == 0 || Duty > Pwm->DutyMax)
+      {
+         Pwm->DutyMax = Duty;
+      }
+
+      AddSample(&Pwm->PeriodNs, PeriodNs);
+      AddSample(&Pwm->HighNs, HighNs);
+      Pwm->PeriodCnt++;
+
+   }
+
+} /* End AddPeriod() */
+
+
+/******************************************************************************
+** Function: AddSample
+**
+*/
+static void AddSample(PWM_Stats_t *Stats, uint64 Sample)
+{
+
+   if (Sample < Stats->Min)
+   {
+      Stats->Min = Sample;
+   }
+   if (Sample > Stats->Max)
+   {
+      Stats->Max = Sample;
+   }
+   Stats->Sum += Sample;
+
+} /* End AddSample() */
+
+
+/******************************************************************************
+** Function: ResetWindow
+**
+** Notes:
+**   1. The edge pairing isn't reset so a period spanning the window boundary
+**      is counted in the window it ends in.
+**   2. The window's end is paced by WindowPacer, the start is only used to
+**      report the window length.
+**
+*/
+static void ResetWindow(PWM_Class_t *Pwm, uint64 NowNs)
+{
+
+   Pwm->WindowStartNs = NowNs;
+   Pwm->PeriodCnt     = 0;
+   Pwm->PeriodNs.Min  = UINT64_MAX;
+   Pwm->PeriodNs.Max  = 0;
+   Pwm->PeriodNs.Sum  = 0;
+   Pwm->HighNs        = Pwm->PeriodNs;
+   Pwm->DutyMin       = 0.0;
+   Pwm->DutyMax       = 0.0;
+
+} /* End ResetWindow() */
@@ -0,0 +1,172 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the PWM measurement class
+**
+**  Notes:
+**    1. Measures a PWM signal on a GPIO character device line. Each period
+**       runs from one rising edge to the next and its high time from the
+**       rising edge to the falling edge between them.
+**    2. Running min, max and mean statistics are kept over a window of
+**       PWM_WINDOW_MS and PwmTlm is sent at the end of each window. Windows
+**       are paced at a fixed cadence like the other modes' telemetry. Edges
+**       only update the statistics so there are no per-edge messages.
+**    3. The PWM object is owned by the Button object and serviced by the
+**       Button child task when BTN_MODE is "pwm".
+**
+*/
+
+#ifndef _pwm_
+#define _pwm_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+#include "gpio_cdev.h"
+#include "pacer.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+
+/*
+** Event Message IDs
+*/
+
+#define PWM_CONSTRUCTOR_EID  (PWM_BASE_EID + 0)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+/******************************************************************************
+** PWM_Stats
+**
+** Running statistics for one measurement over a window, min is initialized
+** to the maximum value so the first sample replaces it.
+*/
+
+typedef struct
+{
+
+   uint64  Min;
+   uint64  Max;
+   uint64  Sum;
+
+} PWM_Stats_t;
+
+
+/******************************************************************************
+** PWM_Class
+*/
+
+typedef struct
+{
+
+   /*
+   ** Class State Data
+   */
+
+   bool    Connected;
+   GPIO_CDEV_Class_t GpioCdev;
+
+   uint32  LastSeqNo;
+   bool    RisingValid;
+   uint64  RisingNs;              /* Kernel timestamp of the last rising edge */
+   bool    FallingValid;          /* A falling edge followed RisingNs */
+   uint64  FallingNs;
+
+   PACER_Class_t WindowPacer;
+   uint64  WindowStartNs;
+   uint32  PeriodCnt;             /* Complete periods in the window */
+   PWM_Stats_t PeriodNs;
+   PWM_Stats_t HighNs;
+   double  DutyMin;
+   double  DutyMax;
+
+   /*
+   ** Statistics
+   */
+
+   uint32  InvalidCnt;            /* Periods discarded because an edge was missing */
+
+   RPI_BTN_PwmTlm_t Tlm;
+
+} PWM_Class_t;
+
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: PWM_Constructor
+**
+** Initialize a PWM object to a known state and request its line.
+**
+** Notes:
+**   1. Returns true if the line was requested.
+**
+*/
+bool PWM_Constructor(PWM_Class_t *Pwm, INITBL_Class_t *IniTbl);
+
+
+/******************************************************************************
+** Function: PWM_ProcessEvents
+**
+** Drain the queued edge events and update the window statistics.
+**
+** Notes:
+**   1. Returns the number of events read or -1 if a read failed.
+**
+*/
+int PWM_ProcessEvents(PWM_Class_t *Pwm);
+
+
+/******************************************************************************
+** Function: PWM_ResetStatus
+**
+** Reset the invalid period and lost event counts.
+**
+*/
+void PWM_ResetStatus(PWM_Class_t *Pwm);
+
+
+/******************************************************************************
+** Function: PWM_SendTlm
+**
+** Send PwmTlm and start a new window if the current window has ended.
+**
+*/
+void PWM_SendTlm(PWM_Class_t *Pwm);
+
+
+/******************************************************************************
+** Function: PWM_TimeoutMs
+**
+** Return the time in milliseconds until the current window ends.
+**
+*/
+int PWM_TimeoutMs(const PWM_Class_t *Pwm);
+
+
+#endif /* _pwm_ */
@@ -37,6 +37,8 @@
 #define  CMDMGR_OBJ    (&(RpiBtn.CmdMgr))
 #define  CHILDMGR_OBJ  (&(RpiBtn.ChildMgr))
 #define  BUTTON_OBJ    (&(RpiBtn.Button))
+#define  CAPTURE_OBJ   (&(RpiBtn.Button.Capture))
+#define  CMD_DIAG_OBJ  (&(RpiBtn.CmdDiag))
 
 
 /*******************************/
@@ -45,7 +47,10 @@
 
 static int32 InitApp(void);
 static int32 ProcessCommands(void);
+static void InitStatusTlmCtrl(void);
 static void SendStatusTlm(void);
+static bool StatusTlmChanged(const RPI_BTN_StatusTlm_Payload_t *Payload,
+                             const RPI_BTN_StatusTlm_Payload_t *LastPayload, bool IgnoreChildWakes);
 
 
 /**********************/
@@ -62,7 +67,8 @@ DEFINE_ENUM(Config,APP_CONFIG)
 static CFE_EVS_BinFilter_t  EventFilters[] =
 {  
    /* Event ID                  Mask */
-   {BUTTON_CHILD_TASK_EID,   CFE_EVS_FIRST_4_STOP}  // Use CFE_EVS_NO_FILTER to see all events
+   {BUTTON_CHILD_TASK_EID,   CFE_EVS_FIRST_4_STOP}, // Use CFE_EVS_NO_FILTER to see all events
+   {KEYPAD_KEY_EID,          CFE_EVS_FIRST_4_STOP}
 
 };
 
@@ -149,12 +155,60 @@ bool RPI_BTN_ResetAppCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr)
    CHILDMGR_ResetStatus(CHILDMGR_OBJ);
    
    BUTTON_ResetStatus();
+   CMD_DIAG_ResetStatus(CMD_DIAG_OBJ);
 	  
    return true;
 
 } /* End RPI_BTN_ResetAppCmd() */
 
 
+/******************************************************************************
+** Function: RPI_BTN_SendStateTlmCmd
+**
+** Notes:
+**   1. The level is read from the line when the command is processed, the
+**      remaining fields are the latest values maintained by the child task.
+**
+*/
+
+bool RPI_BTN_SendStateTlmCmd(void *ObjDataPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+
+   RPI_BTN_StateTlm_Payload_t *StateTlmPayload = &RpiBtn.StateTlm.Payload;
+   BUTTON_State_t ButtonState;
+   int  Level;
+   bool RetStatus = false;
+   
+   if (BUTTON_ReadLevel(&Level))
+   {
+   
+      BUTTON_GetState(&ButtonState);
+      
+      StateTlmPayload->GpioConnected      = ButtonState.GpioConnected;
+      StateTlmPayload->GpioPin            = ButtonState.GpioPin;
+      StateTlmPayload->Level              = Level;
+      StateTlmPayload->PressedCount       = ButtonState.PressedCount;
+      StateTlmPayload->LastRead           = ButtonState.LastRead;
+      StateTlmPayload->LastEdgeSeconds    = ButtonState.LastEdgeTime.Seconds;
+      StateTlmPayload->LastEdgeSubseconds = ButtonState.LastEdgeTime.Subseconds;
+   
+      CFE_SB_TimeStampMsg(CFE_MSG_PTR(RpiBtn.StateTlm.TelemetryHeader));
+      CFE_SB_TransmitMsg(CFE_MSG_PTR(RpiBtn.StateTlm.TelemetryHeader), true);
+      
+      RetStatus = true;
+   
+   } /* End if level read */
+   else
+   {
+      CFE_EVS_SendEvent (RPI_BTN_SEND_STATE_TLM_EID, CFE_EVS_EventType_ERROR,
+                         "Send state telemetry command failed, unable to read button level");
+   }
+   
+   return RetStatus;
+
+} /* End RPI_BTN_SendStateTlmCmd() */
+
+
 /******************************************************************************
 ** Function: InitApp
 **
@@ -177,6 +231,12 @@ static int32 InitApp(void)
       RpiBtn.CmdMid    = CFE_SB_ValueToMsgId(INITBL_GetIntConfig(INITBL_OBJ, CFG_RPI_BTN_CMD_TOPICID));
       RpiBtn.OneHzMid  = CFE_SB_ValueToMsgId(INITBL_GetIntConfig(INITBL_OBJ, CFG_BC_SCH_1_HZ_TOPICID));
       
+      RpiBtn.StatusTlmTickMid = RpiBtn.OneHzMid;
+      if (INITBL_GetIntConfig(INITBL_OBJ, CFG_STATUS_TLM_TICK_TOPICID) != 0)
+      {
+         RpiBtn.StatusTlmTickMid = CFE_SB_ValueToMsgId(INITBL_GetIntConfig(INITBL_OBJ, CFG_STATUS_TLM_TICK_TOPICID));
+      }
+      
       CFE_ES_PerfLogEntry(RpiBtn.PerfId);
 
       /* Constructor sends error events */    
@@ -195,6 +255,8 @@ static int32 InitApp(void)
    {
 
       BUTTON_Constructor(BUTTON_OBJ, &RpiBtn.IniTbl);
+      CMD_DIAG_Constructor(CMD_DIAG_OBJ, &RpiBtn.IniTbl, RpiBtn.CmdMid,
+                           RpiBtn.OneHzMid, RpiBtn.StatusTlmTickMid);
 
       /*
       ** Initialize app level interfaces
@@ -203,12 +265,22 @@ static int32 InitApp(void)
       CFE_SB_CreatePipe(&RpiBtn.CmdPipe, INITBL_GetIntConfig(INITBL_OBJ, CFG_CMD_PIPE_DEPTH), INITBL_GetStrConfig(INITBL_OBJ, CFG_CMD_PIPE_NAME));  
       CFE_SB_Subscribe(RpiBtn.CmdMid,   RpiBtn.CmdPipe);
       CFE_SB_Subscribe(RpiBtn.OneHzMid, RpiBtn.CmdPipe);
+      if (!CFE_SB_MsgId_Equal(RpiBtn.StatusTlmTickMid, RpiBtn.OneHzMid))
+      {
+         CFE_SB_Subscribe(RpiBtn.StatusTlmTickMid, RpiBtn.CmdPipe);
+      }
 
       CMDMGR_Constructor(CMDMGR_OBJ);
       CMDMGR_RegisterFunc(CMDMGR_OBJ, CMDMGR_NOOP_CMD_FC,   NULL, RPI_BTN_NoOpCmd,     0);
       CMDMGR_RegisterFunc(CMDMGR_OBJ, CMDMGR_RESET_CMD_FC,  NULL, RPI_BTN_ResetAppCmd, 0);
+      CMDMGR_RegisterFunc(CMDMGR_OBJ, RPI_BTN_SEND_STATE_TLM_CC, NULL, RPI_BTN_SendStateTlmCmd, 0);
+      CMDMGR_RegisterFunc(CMDMGR_OBJ, RPI_BTN_START_SELF_TEST_CC, BUTTON_OBJ, BUTTON_StartSelfTestCmd, sizeof(RPI_BTN_StartSelfTest_CmdPayload_t));
+      CMDMGR_RegisterFunc(CMDMGR_OBJ, RPI_BTN_ARM_CAPTURE_CC,    CAPTURE_OBJ, CAPTURE_ArmCmd,    sizeof(RPI_BTN_ArmCapture_CmdPayload_t));
+      CMDMGR_RegisterFunc(CMDMGR_OBJ, RPI_BTN_DISARM_CAPTURE_CC, CAPTURE_OBJ, CAPTURE_DisarmCmd, 0);
 
       CFE_MSG_Init(CFE_MSG_PTR(RpiBtn.StatusTlm.TelemetryHeader), CFE_SB_ValueToMsgId(INITBL_GetIntConfig(INITBL_OBJ, CFG_RPI_BTN_STATUS_TLM_TOPICID)), sizeof(RPI_BTN_StatusTlm_t));
+      CFE_MSG_Init(CFE_MSG_PTR(RpiBtn.StateTlm.TelemetryHeader), CFE_SB_ValueToMsgId(INITBL_GetIntConfig(INITBL_OBJ, CFG_RPI_BTN_STATE_TLM_TOPICID)), sizeof(RPI_BTN_StateTlm_t));
+      InitStatusTlmCtrl();
    
       /*
       ** Application startup event message
@@ -227,24 +299,42 @@ static int32 InitApp(void)
 /******************************************************************************
 ** Function: ProcessCommands
 **
+** Notes:
+**   1. When command diagnostics are enabled the pipe is polled before the
+**      blocking receive so queued messages can be identified, see
+**      cmd_diag.h.
+**
 */
 static int32 ProcessCommands(void)
 {
 
    int32  RetStatus = CFE_ES_RunStatus_APP_RUN;
-   int32  SysStatus;
+   int32  SysStatus = CFE_SB_NO_MESSAGE;
+   bool   Queued = false;
 
-   CFE_SB_Buffer_t* SbBufPtr;
-   CFE_SB_MsgId_t   MsgId = CFE_SB_INVALID_MSG_ID;
+   CFE_SB_Buffer_t*  SbBufPtr;
+   CFE_SB_MsgId_t    MsgId  = CFE_SB_INVALID_MSG_ID;
+   CMD_DIAG_MidIdx_t MidIdx = CMD_DIAG_MID_OTHER;
    
 
-   CFE_ES_PerfLogExit(RpiBtn.PerfId);
-   SysStatus = CFE_SB_ReceiveBuffer(&SbBufPtr, RpiBtn.CmdPipe, CFE_SB_PEND_FOREVER);
-   CFE_ES_PerfLogEntry(RpiBtn.PerfId);
+   if (RpiBtn.CmdDiag.Enabled)
+   {
+      SysStatus = CFE_SB_ReceiveBuffer(&SbBufPtr, RpiBtn.CmdPipe, CFE_SB_POLL);
+      Queued = (SysStatus == CFE_SUCCESS);
+   }
+   
+   if (!Queued)
+   {
+      CFE_ES_PerfLogExit(RpiBtn.PerfId);
+      SysStatus = CFE_SB_ReceiveBuffer(&SbBufPtr, RpiBtn.CmdPipe, CFE_SB_PEND_FOREVER);
+      CFE_ES_PerfLogEntry(RpiBtn.PerfId);
+   }
 
    if (SysStatus == CFE_SUCCESS)
    {
       
+      CMD_DIAG_Received(CMD_DIAG_OBJ, Queued);
+      
       SysStatus = CFE_MSG_GetMsgId(&SbBufPtr->Msg, &MsgId);
    
       if (SysStatus == CFE_SUCCESS)
@@ -253,13 +343,26 @@ static int32 ProcessCommands(void)
          if (CFE_SB_MsgId_Equal(MsgId, RpiBtn.CmdMid)) 
          {
             
+            MidIdx = CMD_DIAG_MID_CMD;
             CMDMGR_DispatchFunc(CMDMGR_OBJ, &SbBufPtr->Msg);
          
          } 
-         else if (CFE_SB_MsgId_Equal(MsgId, RpiBtn.OneHzMid))
+         else if (CFE_SB_MsgId_Equal(MsgId, RpiBtn.OneHzMid) ||
+                  CFE_SB_MsgId_Equal(MsgId, RpiBtn.StatusTlmTickMid))
          {
 
-            SendStatusTlm();
+            /* The status telemetry tick may be the 1Hz topic */
+            MidIdx = CMD_DIAG_MID_STATUS_TICK;
+            if (CFE_SB_MsgId_Equal(MsgId, RpiBtn.OneHzMid))
+            {
+               MidIdx = CMD_DIAG_MID_ONE_HZ;
+               BUTTON_UpdatePressRates();
+               BUTTON_RequestChildDiag();
+            }
+            if (CFE_SB_MsgId_Equal(MsgId, RpiBtn.StatusTlmTickMid))
+            {
+               SendStatusTlm();
+            }
             
          }
          else
@@ -278,6 +381,8 @@ static int32 ProcessCommands(void)
                            "CFE couldn't retrieve message ID from the message, Status = %d", SysStatus);
       }
       
+      CMD_DIAG_Processed(CMD_DIAG_OBJ, MidIdx);
+      
    } /* Valid SB receive */ 
    else 
    {
@@ -291,29 +396,149 @@ static int32 ProcessCommands(void)
 } /* End ProcessCommands() */
 
 
+/******************************************************************************
+** Function: InitStatusTlmCtrl
+**
+** Notes:
+**   1. A zero divider is treated as 1 so the configuration can't disable
+**      status telemetry.
+**
+*/
+static void InitStatusTlmCtrl(void)
+{
+
+   RPI_BTN_StatusTlmCtrl_t *Ctrl = &RpiBtn.StatusTlmCtrl;
+   
+   memset(Ctrl, 0, sizeof(RPI_BTN_StatusTlmCtrl_t));
+   
+   Ctrl->Divider          = INITBL_GetIntConfig(INITBL_OBJ, CFG_STATUS_TLM_DIVIDER);
+   Ctrl->ChangeOnly       = (INITBL_GetIntConfig(INITBL_OBJ, CFG_STATUS_TLM_CHANGE_ONLY) != 0);
+   Ctrl->IgnoreChildWakes = (INITBL_GetIntConfig(INITBL_OBJ, CFG_CHILD_DIAG_ENABLE) != 0);
+   Ctrl->KeepAliveTicks   = INITBL_GetIntConfig(INITBL_OBJ, CFG_STATUS_TLM_KEEPALIVE_TICKS);
+   
+   if (Ctrl->Divider == 0)
+   {
+      Ctrl->Divider = 1;
+   }
+   
+   /* Force the first opportunity to send a packet */
+   Ctrl->TickCnt        = Ctrl->Divider - 1;
+   Ctrl->TicksSinceSent = Ctrl->KeepAliveTicks;
+
+} /* End InitStatusTlmCtrl() */
+
+
 /******************************************************************************
 ** Function: SendStatusTlm
 **
+** Notes:
+**   1. Called for every status telemetry tick. A packet is only considered
+**      every StatusTlmCtrl.Divider ticks.
+**   2. In change-only mode a packet is suppressed if its payload is identical
+**      to the last packet sent and the keep-alive interval hasn't expired.
+**   3. When child diagnostics are enabled ChildWakeCnt and ChildSyscallCnt
+**      aren't compared. Each diagnostics sample wakes the child task so they
+**      change every tick and would defeat the suppression.
+**
 */
 static void SendStatusTlm(void)
 {
    
+   RPI_BTN_StatusTlmCtrl_t     *Ctrl = &RpiBtn.StatusTlmCtrl;
    RPI_BTN_StatusTlm_Payload_t *StatusTlmPayload = &RpiBtn.StatusTlm.Payload;
+   BUTTON_State_t ButtonState;
+   bool SendTlm = true;
    
-   StatusTlmPayload->ValidCmdCnt   = RpiBtn.CmdMgr.ValidCmdCnt;
-   StatusTlmPayload->InvalidCmdCnt = RpiBtn.CmdMgr.InvalidCmdCnt;
-
-   StatusTlmPayload->GpioConnected = RpiBtn.Button.GpioConnected;
-   StatusTlmPayload->GpioPin       = RpiBtn.Button.GpioPin;
-   StatusTlmPayload->PressedCount  = RpiBtn.Button.PressedCount;
-   StatusTlmPayload->LastRead      = RpiBtn.Button.LastRead;
-   StatusTlmPayload->LastWrite     = RpiBtn.Button.LastWrite;
+   Ctrl->TicksSinceSent++;
+   if (++Ctrl->TickCnt >= Ctrl->Divider)
+   {
+   
+      Ctrl->TickCnt = 0;
+      
+      StatusTlmPayload->ValidCmdCnt   = RpiBtn.CmdMgr.ValidCmdCnt;
+      StatusTlmPayload->InvalidCmdCnt = RpiBtn.CmdMgr.InvalidCmdCnt;
 
-   /*
-   ** Button
-   */ 
+      BUTTON_GetState(&ButtonState);
+      
+      StatusTlmPayload->GpioConnected = ButtonState.GpioConnected;
+      StatusTlmPayload->GpioPin       = ButtonState.GpioPin;
+      StatusTlmPayload->PressedCount  = ButtonState.PressedCount;
+      StatusTlmPayload->LastRead      = ButtonState.LastRead;
+      StatusTlmPayload->LastWrite     = ButtonState.LastWrite;
+      
+      StatusTlmPayload->PressRate1s   = RpiBtn.Button.PressRate.Rate1s;
+      StatusTlmPayload->PressRate10s  = RpiBtn.Button.PressRate.Rate10s;
+      StatusTlmPayload->PressRate60s  = RpiBtn.Button.PressRate.Rate60s;
+      
+      StatusTlmPayload->EventEngine     = ButtonState.EventEngine;
+      StatusTlmPayload->ChildWakeCnt    = ButtonState.ChildWakeCnt;
+      StatusTlmPayload->ChildSyscallCnt = ButtonState.ChildSyscallCnt;
+      
+      StatusTlmPayload->EdgeSeq       = ButtonState.EdgeSeq;
+      StatusTlmPayload->SourceLostCnt = ButtonState.SourceLostCnt;
+      StatusTlmPayload->EngineLostCnt = ButtonState.EngineLostCnt;
+      StatusTlmPayload->ExportLostCnt = ButtonState.ExportLostCnt;
+      StatusTlmPayload->SbLostCnt     = ButtonState.SbLostCnt;
+      StatusTlmPayload->MacroSentCnt  = ButtonState.MacroSentCnt;
+
+      if (Ctrl->ChangeOnly && (Ctrl->TicksSinceSent < Ctrl->KeepAliveTicks))
+      {
+         SendTlm = StatusTlmChanged(StatusTlmPayload, &Ctrl->LastSentPayload, Ctrl->IgnoreChildWakes);
+      }
+      
+      if (SendTlm)
+      {
+         CFE_SB_TimeStampMsg(CFE_MSG_PTR(RpiBtn.StatusTlm.TelemetryHeader));
+         CFE_SB_TransmitMsg(CFE_MSG_PTR(RpiBtn.StatusTlm.TelemetryHeader), true);
    
-   CFE_SB_TimeStampMsg(CFE_MSG_PTR(RpiBtn.StatusTlm.TelemetryHeader));
-   CFE_SB_TransmitMsg(CFE_MSG_PTR(RpiBtn.StatusTlm.TelemetryHeader), true);
+         Ctrl->LastSentPayload = *StatusTlmPayload;
+         Ctrl->TicksSinceSent  = 0;
+      }
+      
+   } /* End if divider expired */
    
 } /* End SendStatusTlm() */
+
+
+/******************************************************************************
+** Function: StatusTlmChanged
+**
+** Notes:
+**   1. The fields are compared individually because the payload has padding
+**      bytes that struct assignment doesn't preserve.
+**
+*/
+static bool StatusTlmChanged(const RPI_BTN_StatusTlm_Payload_t *Payload,
+                             const RPI_BTN_StatusTlm_Payload_t *LastPayload, bool IgnoreChildWakes)
+{
+
+   bool Changed;
+   
+   Changed = (Payload->ValidCmdCnt   != LastPayload->ValidCmdCnt)   ||
+             (Payload->InvalidCmdCnt != LastPayload->InvalidCmdCnt) ||
+             (Payload->GpioConnected != LastPayload->GpioConnected) ||
+             (Payload->GpioPin       != LastPayload->GpioPin)       ||
+             (Payload->PressedCount  != LastPayload->PressedCount)  ||
+             (Payload->LastRead      != LastPayload->LastRead)      ||
+             (Payload->LastWrite     != LastPayload->LastWrite)     ||
+             (Payload->PressRate1s   != LastPayload->PressRate1s)   ||
+             (Payload->PressRate10s  != LastPayload->PressRate10s)  ||
+             (Payload->PressRate60s  != LastPayload->PressRate60s)  ||
+             (Payload->EventEngine   != LastPayload->EventEngine)   ||
+             (Payload->EdgeSeq       != LastPayload->EdgeSeq)       ||
+             (Payload->SourceLostCnt != LastPayload->SourceLostCnt) ||
+             (Payload->EngineLostCnt != LastPayload->EngineLostCnt) ||
+             (Payload->ExportLostCnt != LastPayload->ExportLostCnt) ||
+             (Payload->SbLostCnt     != LastPayload->SbLostCnt)     ||
+             (Payload->MacroSentCnt  != LastPayload->MacroSentCnt);
+   
+   if (!IgnoreChildWakes)
+   {
+      Changed = Changed ||
+                (Payload->ChildWakeCnt    != LastPayload->ChildWakeCnt) ||
+                (Payload->ChildSyscallCnt != LastPayload->ChildSyscallCnt);
+   }
+   
+   return Changed;
+
+} /* End StatusTlmChanged() */
@@ -33,6 +33,7 @@
 #include "childmgr.h"
 #include "initbl.h"
 #include "button.h"
+#include "cmd_diag.h"
 
 /***********************/
 /** Macro Definitions **/
@@ -46,6 +47,7 @@
 #define RPI_BTN_NOOP_EID        (RPI_BTN_BASE_EID + 1)
 #define RPI_BTN_EXIT_EID        (RPI_BTN_BASE_EID + 2)
 #define RPI_BTN_INVALID_MID_EID (RPI_BTN_BASE_EID + 3)
+#define RPI_BTN_SEND_STATE_TLM_EID (RPI_BTN_BASE_EID + 4)
 
 
 /**********************/
@@ -65,6 +67,27 @@
 */
 
 
+/******************************************************************************
+** Status telemetry rate control
+**
+** - Divider and tick counts are in units of status telemetry tick messages
+*/
+typedef struct
+{
+
+   uint32  Divider;
+   uint32  TickCnt;
+   
+   bool    ChangeOnly;
+   bool    IgnoreChildWakes;   /* Child diagnostics wake the child task every 1Hz tick */
+   uint32  KeepAliveTicks;
+   uint32  TicksSinceSent;
+   
+   RPI_BTN_StatusTlm_Payload_t LastSentPayload;
+   
+} RPI_BTN_StatusTlmCtrl_t;
+
+
 /******************************************************************************
 ** RPI_BTN_Class
 */
@@ -85,6 +108,9 @@ typedef struct
    */
    
    RPI_BTN_StatusTlm_t  StatusTlm;
+   RPI_BTN_StateTlm_t   StateTlm;
+   
+   RPI_BTN_StatusTlmCtrl_t StatusTlmCtrl;
 
    /*
    ** App State & Objects
@@ -93,8 +119,10 @@ typedef struct
    uint32          PerfId;
    CFE_SB_MsgId_t  CmdMid;
    CFE_SB_MsgId_t  OneHzMid;
+   CFE_SB_MsgId_t  StatusTlmTickMid;
    
-   BUTTON_Class_t  Button;
+   CMD_DIAG_Class_t  CmdDiag;
+   BUTTON_Class_t    Button;
  
 } RPI_BTN_Class_t;
 
@@ -132,4 +160,14 @@ bool RPI_BTN_NoOpCmd(void* ObjDataPtr, const CFE_MSG_Message_t *MsgPtr);
 bool RPI_BTN_ResetAppCmd(void* ObjDataPtr, const CFE_MSG_Message_t *MsgPtr);
 
 
+/******************************************************************************
+** Function: RPI_BTN_SendStateTlmCmd
+**
+** Read the button line and send a state telemetry packet without waiting for
+** the next scheduled status telemetry.
+**
+*/
+bool RPI_BTN_SendStateTlmCmd(void* ObjDataPtr, const CFE_MSG_Message_t *MsgPtr);
+
+
 #endif /* _rpi_btn_app_ */
@@ -0,0 +1,199 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the shared memory export Class methods
+**
+**  Notes:
+**    1. Seq is a plain uint32_t in the layout so non-C11 readers can use
+**       it, the writer uses the same __atomic builtins as the readers in
+**       rpi_btn_shm.h.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "shm_export.h"
+
+
+/******************************************************************************
+** Function: SHM_EXPORT_Constructor
+**
+** Notes:
+**   1. Magic is stored last so a reader that maps the segment while it's
+**      being initialized doesn't use it.
+**
+*/
+bool SHM_EXPORT_Constructor(SHM_EXPORT_Class_t *ShmExport, const char *Name)
+{
+
+   RPI_BTN_Shm_t *Shm;
+   int  FileDescr;
+
+   memset(ShmExport, 0, sizeof(SHM_EXPORT_Class_t));
+
+   if (Name[0] == '\0')
+   {
+      return false;
+   }
+
+   FileDescr = shm_open(Name, O_CREAT | O_RDWR | O_CLOEXEC, 0644);
+   if (FileDescr < 0)
+   {
+      CFE_EVS_SendEvent(SHM_EXPORT_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                        "Failed to open shared memory segment %s, errno %d", Name, errno);
+      return false;
+   }
+
+   if (ftruncate(FileDescr, sizeof(RPI_BTN_Shm_t)) == 0)
+   {
+
+      Shm = mmap(NULL, sizeof(RPI_BTN_Shm_t), PROT_READ | PROT_WRITE, MAP_SHARED, FileDescr, 0);
+      if (Shm != MAP_FAILED)
+      {
+
+         memset(Shm, 0, sizeof(RPI_BTN_Shm_t));
+
+         Shm->Version     = RPI_BTN_SHM_VERSION;
+         Shm->EdgeRingLen = RPI_BTN_SHM_EDGE_RING_LEN;
+         Shm->Size        = sizeof(RPI_BTN_Shm_t);
+         Shm->WriterPid   = (uint32)getpid();
+         __atomic_store_n(&Shm->Magic, RPI_BTN_SHM_MAGIC, __ATOMIC_RELEASE);
+
+         ShmExport->Shm = Shm;
+
+         CFE_EVS_SendEvent(SHM_EXPORT_CONSTRUCTOR_EID, CFE_EVS_EventType_INFORMATION,
+                           "Exporting button state to shared memory segment %s, layout version %d, %d bytes",
+                           Name, RPI_BTN_SHM_VERSION, (int)sizeof(RPI_BTN_Shm_t));
+
+      }
+      else
+      {
+         CFE_EVS_SendEvent(SHM_EXPORT_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                           "Failed to map shared memory segment %s, errno %d", Name, errno);
+      }
+
+   } /* End if sized */
+   else
+   {
+      CFE_EVS_SendEvent(SHM_EXPORT_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                        "Failed to size shared memory segment %s to %d bytes, errno %d",
+                        Name, (int)sizeof(RPI_BTN_Shm_t), errno);
+   }
+
+   /* The mapping stays valid after the descriptor is closed */
+   close(FileDescr);
+
+   return (ShmExport->Shm != NULL);
+
+} /* End SHM_EXPORT_Constructor() */
+
+
+/******************************************************************************
+** Function: SHM_EXPORT_AddEdge
+**
+*/
+void SHM_EXPORT_AddEdge(SHM_EXPORT_Class_t *ShmExport, uint32 EdgeSeq, uint64 TimeNs, uint8 Level)
+{
+
+   RPI_BTN_ShmEdge_t *Edge;
+
+   if (ShmExport->Shm != NULL)
+   {
+
+      if (ShmExport->StagedCnt >= RPI_BTN_SHM_EDGE_RING_LEN)
+      {
+         ShmExport->OverrunCnt++;
+      }
+
+      ShmExport->EdgeSeq = EdgeSeq;
+
+      Edge = &ShmExport->Staged[ShmExport->StagedCnt % RPI_BTN_SHM_EDGE_RING_LEN];
+      Edge->TimeNs = TimeNs;
+      Edge->Number = EdgeSeq;
+      Edge->Level  = Level;
+      ShmExport->StagedCnt++;
+
+      ShmExport->LastEdgeNs = TimeNs;
+
+   }
+
+} /* End SHM_EXPORT_AddEdge() */
+
+
+/******************************************************************************
+** Function: SHM_EXPORT_Publish
+**
+** Notes:
+**   1. Sequence lock writer, see BUTTON_GetState() for the same protocol
+**      between the child and main tasks.
+**
+*/
+void SHM_EXPORT_Publish(SHM_EXPORT_Class_t *ShmExport, bool Connected, uint8 GpioPin,
+                        uint32 PressedCount, uint8 Level)
+{
+
+   RPI_BTN_Shm_t *Shm = ShmExport->Shm;
+   RPI_BTN_ShmEdge_t *Edge;
+   uint32 Seq;
+   uint32 i;
+
+   if (Shm != NULL)
+   {
+
+      Seq = __atomic_load_n(&Shm->Seq, __ATOMIC_RELAXED);
+      __atomic_store_n(&Shm->Seq, Seq + 1, __ATOMIC_RELAXED);
+      __atomic_thread_fence(__ATOMIC_RELEASE);
+
+      i = (ShmExport->StagedCnt > RPI_BTN_SHM_EDGE_RING_LEN) ? ShmExport->StagedCnt - RPI_BTN_SHM_EDGE_RING_LEN : 0;
+      for (; i < ShmExport->StagedCnt; i++)
+      {
+         Edge = &ShmExport->Staged[i % RPI_BTN_SHM_EDGE_RING_LEN];
+         Shm->Edge[(Edge->Number - 1) % RPI_BTN_SHM_EDGE_RING_LEN] = *Edge;
+      }
+
+      Shm->State.LastEdgeNs   = ShmExport->LastEdgeNs;
+      Shm->State.PressedCount = PressedCount;
+      Shm->State.EdgeSeq      = ShmExport->EdgeSeq;
+      Shm->State.Connected    = Connected;
+      Shm->State.GpioPin      = GpioPin;
+      Shm->State.Level        = Level;
+
+      __atomic_store_n(&Shm->Seq, Seq + 2, __ATOMIC_RELEASE);
+
+      ShmExport->StagedCnt = 0;
+
+   } /* End if export enabled */
+
+} /* End SHM_EXPORT_Publish() */
+
+
+/******************************************************************************
+** Function: SHM_EXPORT_ResetStatus
+**
+*/
+void SHM_EXPORT_ResetStatus(SHM_EXPORT_Class_t *ShmExport)
+{
+
+   ShmExport->OverrunCnt = 0;
+
+} /* End SHM_EXPORT_ResetStatus() */
@@ -0,0 +1,136 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the shared memory export class
+**
+**  Notes:
+**    1. Writes the live button state and a ring of recent edges into the
+**       POSIX shared memory segment defined in rpi_btn_shm.h so local
+**       non-cFE processes can read them without the software bus.
+**    2. The Button child task is the only writer. Edges are staged with
+**       SHM_EXPORT_AddEdge() and written with the state by one sequence
+**       locked update in SHM_EXPORT_Publish() so readers always see edges
+**       and state that agree.
+**
+*/
+
+#ifndef _shm_export_
+#define _shm_export_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+#include "rpi_btn_shm.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+
+/*
+** Event Message IDs
+*/
+
+#define SHM_EXPORT_CONSTRUCTOR_EID  (SHM_EXPORT_BASE_EID + 0)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+/******************************************************************************
+** SHM_EXPORT_Class
+*/
+
+typedef struct
+{
+
+   /*
+   ** Class State Data
+   */
+
+   RPI_BTN_Shm_t  *Shm;           /* NULL when the export is disabled */
+
+   uint32  EdgeSeq;               /* Includes staged edges */
+   uint32  StagedCnt;
+   uint64  LastEdgeNs;
+   RPI_BTN_ShmEdge_t  Staged[RPI_BTN_SHM_EDGE_RING_LEN];
+
+   /*
+   ** Statistics
+   */
+
+   uint32  OverrunCnt;            /* Staged edges overwritten before they were published */
+
+} SHM_EXPORT_Class_t;
+
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: SHM_EXPORT_Constructor
+**
+** Create and map the shared memory segment.
+**
+** Notes:
+**   1. An empty Name disables the export. A failure sends an error event
+**      and disables the export, it doesn't affect the rest of the app.
+**   2. An existing segment with the same name is reused and reinitialized.
+**
+*/
+bool SHM_EXPORT_Constructor(SHM_EXPORT_Class_t *ShmExport, const char *Name);
+
+
+/******************************************************************************
+** Function: SHM_EXPORT_AddEdge
+**
+** Stage an edge for the next SHM_EXPORT_Publish().
+**
+** Notes:
+**   1. EdgeSeq is the edge's sequence number, gaps are edges lost upstream.
+**   2. If more than RPI_BTN_SHM_EDGE_RING_LEN edges are staged only the
+**      newest are kept and the others are counted in OverrunCnt.
+**
+*/
+void SHM_EXPORT_AddEdge(SHM_EXPORT_Class_t *ShmExport, uint32 EdgeSeq, uint64 TimeNs, uint8 Level);
+
+
+/******************************************************************************
+** Function: SHM_EXPORT_Publish
+**
+** Write the staged edges and the current state to the segment.
+**
+*/
+void SHM_EXPORT_Publish(SHM_EXPORT_Class_t *ShmExport, bool Connected, uint8 GpioPin,
+                        uint32 PressedCount, uint8 Level);
+
+
+/******************************************************************************
+** Function: SHM_EXPORT_ResetStatus
+**
+** Reset the overrun count.
+**
+*/
+void SHM_EXPORT_ResetStatus(SHM_EXPORT_Class_t *ShmExport);
+
+
+#endif /* _shm_export_ */